@@ -0,0 +1,149 @@
+//
+//	インスタンス描画用の3Dシェーダー（Siv3Dのdefault3d_forward.hlslをベースにしている）
+//	インスタンスごとのワールド行列と色を定数バッファ(b4)から読み、SV_InstanceIDで参照する
+//	InstancedRenderingSystemが同じメッシュ・テクスチャのエンティティをまとめてMesh::drawInstanced()で描画する
+//
+
+//
+//	Textures
+//
+Texture2D		g_texture0 : register(t0);
+SamplerState	g_sampler0 : register(s0);
+
+namespace s3d
+{
+	//
+	//	VS Input
+	//
+	struct VSInput
+	{
+		float4 position : POSITION;
+		float3 normal : NORMAL;
+		float2 uv : TEXCOORD0;
+		uint instanceID : SV_InstanceID;
+	};
+
+	//
+	//	VS Output / PS Input
+	//
+	struct PSInput
+	{
+		float4 position : SV_POSITION;
+		float3 worldPosition : TEXCOORD0;
+		float2 uv : TEXCOORD1;
+		float3 normal : TEXCOORD2;
+		nointerpolation float4 color : TEXCOORD3;
+	};
+}
+
+//
+//	Constant Buffer
+//
+cbuffer VSPerView : register(b1)
+{
+	row_major float4x4 g_worldToProjected;
+}
+
+cbuffer VSPerMaterial : register(b3)
+{
+	float4 g_uvTransform;
+}
+
+// InstanceBatchCB::kMaxInstances（FrameWork/SingletonCD/InstancedRenderSingletonCD.h）と一致させる
+#define MAX_INSTANCES 512
+
+struct Instance
+{
+	row_major float4x4 localToWorld;
+	float4 color;
+};
+
+cbuffer VSInstances : register(b4)
+{
+	Instance g_instances[MAX_INSTANCES];
+}
+
+cbuffer PSPerFrame : register(b0)
+{
+	float3 g_globalAmbientColor;
+	float3 g_sunColor;
+	float3 g_sunDirection;
+}
+
+cbuffer PSPerView : register(b1)
+{
+	float3 g_eyePosition;
+}
+
+cbuffer PSPerMaterial : register(b3)
+{
+	float3 g_ambientColor;
+	uint   g_hasTexture;
+	float4 g_diffuseColor;
+	float3 g_specularColor;
+	float  g_shininess;
+	float3 g_emissionColor;
+}
+
+//
+//	Functions
+//
+s3d::PSInput VS(s3d::VSInput input)
+{
+	s3d::PSInput result;
+
+	const Instance instance = g_instances[input.instanceID];
+	const float4 worldPosition = mul(input.position, instance.localToWorld);
+
+	result.position			= mul(worldPosition, g_worldToProjected);
+	result.worldPosition	= worldPosition.xyz;
+	result.uv				= (input.uv * g_uvTransform.xy + g_uvTransform.zw);
+	result.normal			= mul(input.normal, (float3x3)instance.localToWorld);
+	result.color			= instance.color;
+	return result;
+}
+
+float4 GetDiffuseColor(float2 uv, float4 instanceColor)
+{
+	float4 diffuseColor = (g_diffuseColor * instanceColor);
+
+	if (g_hasTexture)
+	{
+		diffuseColor *= g_texture0.Sample(g_sampler0, uv);
+	}
+
+	return diffuseColor;
+}
+
+float3 CalculateDiffuseReflection(float3 n, float3 l, float3 lightColor, float3 diffuseColor, float3 ambientColor)
+{
+	const float3 directColor = lightColor * saturate(dot(n, l));
+	return ((ambientColor + directColor) * diffuseColor);
+}
+
+float3 CalculateSpecularReflection(float3 n, float3 h, float shininess, float nl, float3 lightColor, float3 specularColor)
+{
+	const float highlight = pow(saturate(dot(n, h)), shininess) * float(0.0 < nl);
+	return (lightColor * specularColor * highlight);
+}
+
+float4 PS(s3d::PSInput input) : SV_TARGET
+{
+	const float3 lightColor		= g_sunColor;
+	const float3 lightDirection	= g_sunDirection;
+
+	const float3 n = normalize(input.normal);
+	const float3 l = lightDirection;
+	const float4 diffuseColor = GetDiffuseColor(input.uv, input.color);
+	const float3 ambientColor = (g_ambientColor * g_globalAmbientColor);
+
+	// Diffuse
+	const float3 diffuseReflection = CalculateDiffuseReflection(n, l, lightColor, diffuseColor.rgb, ambientColor);
+
+	// Specular
+	const float3 v = normalize(g_eyePosition - input.worldPosition);
+	const float3 h = normalize(v + lightDirection);
+	const float3 specularReflection = CalculateSpecularReflection(n, h, g_shininess, dot(n, l), lightColor, g_specularColor);
+
+	return float4(diffuseReflection + specularReflection + g_emissionColor, diffuseColor.a);
+}
@@ -0,0 +1,69 @@
+//
+//	UVをスクロールさせる3D用の頂点シェーダー（Siv3Dのdefault3d_forward.hlslのVSをベースにしている）
+//	ピクセルシェーダーは標準のものをそのまま使う
+//	UVScrollMaterialが定数バッファ(b4)にオフセットを書き込み、メッシュ自体は作り直さずにテクスチャを流す
+//
+
+namespace s3d
+{
+	//
+	//	VS Input
+	//
+	struct VSInput
+	{
+		float4 position : POSITION;
+		float3 normal : NORMAL;
+		float2 uv : TEXCOORD0;
+	};
+
+	//
+	//	VS Output / PS Input
+	//
+	struct PSInput
+	{
+		float4 position : SV_POSITION;
+		float3 worldPosition : TEXCOORD0;
+		float2 uv : TEXCOORD1;
+		float3 normal : TEXCOORD2;
+	};
+}
+
+//
+//	Constant Buffer
+//
+cbuffer VSPerView : register(b1)
+{
+	row_major float4x4 g_worldToProjected;
+}
+
+cbuffer VSPerObject : register(b2)
+{
+	row_major float4x4 g_localToWorld;
+}
+
+cbuffer VSPerMaterial : register(b3)
+{
+	float4 g_uvTransform;
+}
+
+// UVScrollCBと一致させる
+cbuffer VSUVScroll : register(b4)
+{
+	float2 g_uvOffset;
+}
+
+//
+//	Functions
+//
+s3d::PSInput VS(s3d::VSInput input)
+{
+	s3d::PSInput result;
+
+	const float4 worldPosition = mul(input.position, g_localToWorld);
+
+	result.position			= mul(worldPosition, g_worldToProjected);
+	result.worldPosition	= worldPosition.xyz;
+	result.uv				= (input.uv * g_uvTransform.xy + g_uvTransform.zw) + g_uvOffset;
+	result.normal			= mul(input.normal, (float3x3)g_localToWorld);
+	return result;
+}
@@ -2,6 +2,7 @@
 
 #pragma once
 # include <Siv3D.hpp> //OpenSiv3D v0.6.16 動作チェック済み
+# include "Util/FramePacer.h"
 namespace chrono = std::chrono;
 
 #pragma region このファイルの使い方(設定方法)
@@ -95,9 +96,8 @@ public:
 		DisplaySet();
 	}
 
-#pragma optimize("", off)
 	/// @brief ６０FPS　で System::Update() を行う 
-	/// @return フレームスキップする場合、描画しない
+	/// @brief 待機とフレームスキップはFramePacerに任せる（空ループで待たないのでCPUを占有しない）
 	static bool Update()
 	{
 		_ASSERT_EXPR(IsDisplaySet, L"\n\n  while(System60::Update())  の前に \n\n System60::SetDisplaySize(～ )\n\nで設定して下さい ");
@@ -108,32 +108,20 @@ public:
 			DisplaySet();	// 本当はMain()に入る直前に行いたいのだが仕方なく
 		}
 
-		auto elapset = [&]()
-			{
-				auto end = chrono::high_resolution_clock::now();
-				auto durtion = end - start;        // 要した時間を計算
-				auto nanosecound = chrono::duration_cast<std::chrono::nanoseconds>(durtion).count();
-				return nanosecound;
-			};
-		/// @brief フレームスキップ確認、１フレーム時間を超えたら描画せずに次のループへ
-		/// @return true
-		if (elapset() > 1000 * 1000 * 1000 / (long long)FPS)
+		if (!IsPacerSet)
 		{
-			start = chrono::high_resolution_clock::now();      // 計測スタート時刻を保存
-			return true;
+			IsPacerSet = true;
+			FramePacer::SetTargetFPS(FPS);
 		}
-		long long sleepTime = elapset() / (long long)(1000000.0-100.0) / (long long)2.0; // -100.0 は微調整
-		System::Sleep((int32)sleepTime);
-		while (elapset() < 1000 * 1000 * 1000 / FPS); //16
-		// Sleep精度が不安なのでしかたなく待機時間の半分を空ループにした。動作は安定している
 
 		start = chrono::high_resolution_clock::now();      // 計測スタート時刻を保存
 
-		return System::Update();
+		return FramePacer::Update();
 	}
 
 private:
 	inline static bool IsDisplaySet = false;
+	inline static bool IsPacerSet = false;
 	/// @brief 画面サイズ変更
 	/// @param displayResolution 画素数指定 
 	/// @return 画面変更成功
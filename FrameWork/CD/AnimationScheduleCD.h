@@ -0,0 +1,9 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+
+// スプライトアニメーションの次のフレーム切り替えの予定
+// SpriteAnimationSystemがタイマーホイールに登録したティックを保持し、
+// ホイールから取り出した通知がこの値と一致するときだけフレームを進める（古い登録の無効化に使う）
+struct AnimationScheduleCD {
+  uint64 due_tick = 0;  // 0なら予定なし（ループしないアニメーションが最後のフレームに達した）
+};
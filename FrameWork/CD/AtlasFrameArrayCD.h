@@ -0,0 +1,14 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+#include <vector>
+
+// アトラス上に詰め込んだアニメーションのフレーム
+// TextureArrayCDと違い、フレームの切り替えはSpriteRegionCDの領域を差し替えるだけで行う
+struct AtlasFrameArrayCD {
+  struct Frame {
+    Texture atlas;
+    Rect region;
+  };
+
+  std::vector<Frame> frames;
+};
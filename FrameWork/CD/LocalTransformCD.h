@@ -0,0 +1,15 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+
+// 親エンティティ（flecs::ChildOf）から見た相対的な姿勢
+// TransformSystemが親のPositionCD/RotationCDと合成し、自身のPositionCD/RotationCDへ書き込む
+// TransformSystemはflecsの変更検出で再計算を省くため、pos/rotの書き換えはset()/modified()か、
+// LocalTransformCDを非constで受け取るシステムの中で行うこと（get_mut()で書き換えただけでは反映されない）
+struct LocalTransformCD {
+  LocalTransformCD() = default;
+  LocalTransformCD(const Vec3& p, const Quaternion& r = Quaternion::Identity())
+      : pos(p), rot(r) {}
+
+  Vec3 pos = Vec3::Zero();
+  Quaternion rot = Quaternion::Identity();
+};
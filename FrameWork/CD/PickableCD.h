@@ -0,0 +1,8 @@
+﻿#pragma once
+
+// 3D空間でマウスによるピッキングの対象になるCD
+// PhysXのActor（StaticBodyCD/DynamicBodyCD）を持つ場合はそのシェイプで判定し、
+// 持たない場合はPositionCDを中心とした半径radiusの球で判定する
+struct PickableCD {
+  double radius = 0.5;
+};
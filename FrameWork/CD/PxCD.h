@@ -1,6 +1,4 @@
 ﻿#pragma once
-#include <functional>
-
 #include "PxPhysicsAPI.h"
 #include "Util/PxUtil.h"
 #include "flecs/flecs.h"
@@ -13,24 +11,19 @@ struct DynamicBodyCD {
   physx::PxRigidDynamic* rigid = nullptr;
 };
 
+// 描画用に姿勢を補間するためのCD
+// 直前の固定ステップ開始時の姿勢を保持し、現在の姿勢との間を補間する
+struct PxInterpolationCD {
+  physx::PxTransform previous = physx::PxTransform(physx::PxIdentity);
+};
+
 struct PxShapeCD {
   physx::PxShape* shape = nullptr;
 };
 
 // トリガーCD - 物理トリガーとして機能するコンポーネント
+// enter/stay/exitはPxEventSingletonCDに集約されるため、ここではコールバックを持たない
 struct TriggerCD {
-  // トリガーが有効かどうか
+  // トリガーが有効かどうか（falseの間はトリガーイベントを発生させない）
   bool isEnabled = true;
-
-  // トリガー発火時に実行するコールバック関数
-  // 引数: トリガーに接触したエンティティのID
-  std::function<void(flecs::entity)> onTriggerEnter = nullptr;
-
-  // トリガーから離脱した時に実行するコールバック関数
-  // 引数: トリガーから離脱したエンティティのID
-  std::function<void(flecs::entity)> onTriggerExit = nullptr;
-
-  // トリガーが継続的に接触している時に実行するコールバック関数
-  // 引数: トリガーに接触しているエンティティのID
-  std::function<void(flecs::entity)> onTriggerStay = nullptr;
 };
@@ -0,0 +1,13 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+
+// アトラス上の領域として描画するスプライトのCD
+// 同じアトラスを使うスプライトはSpriteRenderingSystemでまとめて描画される
+struct SpriteRegionCD {
+  SpriteRegionCD() = default;
+  SpriteRegionCD(const Texture& atlas, const Rect& region)
+      : atlas(atlas), region(region) {}
+
+  Texture atlas;
+  Rect region;
+};
@@ -0,0 +1,13 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+
+// TextCDを配置済みのグリフの矩形としてキャッシュするCD
+// TextUISystemがTextCD・ScalarScaleCD・フォントの変更時にだけ作り直し、描画時はこの矩形を並べるだけにする
+struct TextLayoutCD {
+  struct Quad {
+    TextureRegion region;  // フォントのアトラス上のグリフ（拡大縮小済み）
+    Vec2 offset;           // 描画位置（PositionCD）からの相対位置
+  };
+
+  Array<Quad> quads;
+};
@@ -1,8 +1,12 @@
 ﻿#pragma once
 #include <Siv3D.hpp>
+#include <span>
+#include <vector>
 
+#include "CD/AtlasFrameArrayCD.h"
 #include "CD/ColorCD.h"
 #include "CD/FrameCD.h"
+#include "CD/LocalTransformCD.h"
 #include "CD/MeshCD.h"
 #include "CD/PositionCD.h"
 #include "CD/PxCD.h"
@@ -11,13 +15,15 @@
 #include "CD/ScalarScaleCD.h"
 #include "CD/Size2DCD.h"
 #include "CD/SpriteAnimationCD.h"
+#include "CD/SpriteRegionCD.h"
 #include "CD/TextCD.h"
 #include "CD/TextureArrayCD.h"
 #include "CD/TextureCD.h"
-#include "CD/TimerCD.h"
 #include "Helper/PxCDHelper.h"
 #include "SharedCD/FontSharedCD.h"
 #include "SingletonCD/PxDataSingletonCD.h"
+#include "SingletonCD/SpriteAtlasSingletonCD.h"
+#include "Util/AssetCache.h"
 #include "Util/FontUtil.h"
 #include "flecs/flecs.h"
 
@@ -40,6 +46,15 @@ class EntityFactory {
   static inline bool s_initialized = false;
 
   public:
+  // 一括生成用の姿勢
+  struct SpawnTransform {
+    Vec3 pos = Vec3::Zero();
+    Quaternion rot = Quaternion::Identity();
+  };
+
+  // 動的なActorを1つのPxAggregateにまとめる数の既定値
+  static constexpr uint32 kDefaultAggregateSize = 128;
+
   // 初期化処理
   static void Initialize(flecs::world& world) {
     if (s_initialized) return;
@@ -67,6 +82,7 @@ class EntityFactory {
     s_dynamicSpherePrefab.add<MeshCD>();
     s_dynamicSpherePrefab.add<ColorCD>();
     s_dynamicSpherePrefab.add<DynamicBodyCD>();
+    s_dynamicSpherePrefab.add<PxInterpolationCD>();
     s_dynamicSpherePrefab.add<PxShapeCD>();
 
     s_textUIPrefab = world.prefab("TextUIPrefab");
@@ -75,6 +91,9 @@ class EntityFactory {
     s_textUIPrefab.add<TextCD>();
     s_textUIPrefab.add<ColorCD>();
 
+    // フォント名の索引（FontUtil::FindFontCD）を用意する
+    FontUtil::InitializeFontIndex(world);
+
     s_standardFontPrefab = world.prefab("StandardFontPrefab");
     s_standardFontPrefab.add<FontSharedCD>();
 
@@ -84,17 +103,16 @@ class EntityFactory {
     s_textureSpritePrefab = world.prefab("TextureSpritePrefab");
     s_textureSpritePrefab.add<PositionCD>();
     s_textureSpritePrefab.add<Rotation2DCD>();
-    s_textureSpritePrefab.add<TextureCD>();
+    s_textureSpritePrefab.add<SpriteRegionCD>();
 
     s_spriteAnimationPrefab = world.prefab("SpriteAnimationPrefab");
     s_spriteAnimationPrefab.add<PositionCD>();
     s_spriteAnimationPrefab.add<Rotation2DCD>();
     s_spriteAnimationPrefab.add<ScalarScaleCD>();
-    s_spriteAnimationPrefab.add<TextureCD>();
+    s_spriteAnimationPrefab.add<SpriteRegionCD>();
     s_spriteAnimationPrefab.add<SpriteAnimationCD>();
-    s_spriteAnimationPrefab.add<TextureArrayCD>();
+    s_spriteAnimationPrefab.add<AtlasFrameArrayCD>();
     s_spriteAnimationPrefab.add<FrameCD>();
-    s_spriteAnimationPrefab.add<TimerCD>();
 
     s_initialized = true;
   }
@@ -111,6 +129,7 @@ class EntityFactory {
 
     StaticBodyCD body;
     PxCDHelper::CreatePlane(body, px);
+    PxCDHelper::BindEntity(*body.rigid, entity);
     px.AddActor(entity, *body.rigid);
     entity.set<StaticBodyCD>(body);
 
@@ -127,9 +146,9 @@ class EntityFactory {
     entity.set<RotationCD>(RotationCD(rot));
 
     if (!texture_path.isEmpty()) {
-      TextureCD tex = Texture(texture_path, TextureDesc::MippedSRGB);
+      TextureCD tex = GetTexture(texture_path);
       entity.set<TextureCD>(tex);
-      MeshCD model = {Mesh(MeshData::Box(scale))};
+      MeshCD model = {GetBoxMesh(scale)};
       entity.set<MeshCD>(model);
     }
 
@@ -144,6 +163,7 @@ class EntityFactory {
     PxCDHelper::InitStatic(px, body, shape, box);
     body.rigid->setGlobalPose(PxCDHelper::ToTransform(
       entity.get<PositionCD>(), entity.get<RotationCD>()));
+    PxCDHelper::BindEntity(*body.rigid, entity);
     px.AddActor(entity, *body.rigid);
     entity.set<PxShapeCD>(shape);
     entity.set<StaticBodyCD>(body);
@@ -158,7 +178,7 @@ class EntityFactory {
     entity.is_a(s_dynamicSpherePrefab);
     entity.set<PositionCD>(PositionCD(pos));
 
-    MeshCD model = {Mesh(MeshData::Sphere(radius))};
+    MeshCD model = {GetSphereMesh(radius)};
     entity.set<MeshCD>(model);
     entity.set<ColorCD>(ColorCD(color));
 
@@ -174,13 +194,127 @@ class EntityFactory {
     const auto* rot_cd = entity.try_get<RotationCD>();
     assert(pos_cd && rot_cd);
     body.rigid->setGlobalPose(PxCDHelper::ToTransform(*pos_cd, *rot_cd));
+    PxCDHelper::BindEntity(*body.rigid, entity);
     px.AddActor(entity, *body.rigid);
     entity.set<PxShapeCD>(shape);
     entity.set<DynamicBodyCD>(body);
+    entity.set<PxInterpolationCD>({body.rigid->getGlobalPose()});
 
     return entity;
   }
 
+  // 静的な立方体をまとめて生成する
+  // 形状・メッシュ・テクスチャは全インスタンスで共有し、シーンへは1回の呼び出しで追加する
+  // aggregate_sizeを指定した場合はその数ごとにPxAggregateへまとめる（transformsは近いもの同士を連続させること）
+  static Array<flecs::entity> StaticCubes(
+    flecs::world& world, std::span<const SpawnTransform> transforms,
+    const FilePath texture_path = U"", const Vec3& scale = Vec3::One(),
+    uint32 aggregate_size = 0) {
+    Array<flecs::entity> entities;
+    if (transforms.empty()) {
+      return entities;
+    }
+    entities.reserve(transforms.size());
+
+    assert(world.has<PxDataSingletonCD>());
+    PxDataSingletonCD& px = *world.get_ref<PxDataSingletonCD>().get();
+
+    physx::PxShape* box = px.Physics()->createShape(
+      physx::PxBoxGeometry(PxUtil::ToVec(scale / 2.0)), *px.GetDefaultMat(),
+      false);
+    const bool has_texture = !texture_path.isEmpty();
+    const TextureCD tex = has_texture ? GetTexture(texture_path) : Texture();
+    const MeshCD model = {has_texture ? GetBoxMesh(scale) : Mesh()};
+
+    std::vector<physx::PxActor*> actors;
+    actors.reserve(transforms.size());
+
+    // 構造変更はまとめて反映する
+    world.defer_begin();
+    for (const auto& transform : transforms) {
+      auto entity = world.entity();
+      entity.is_a(s_staticCubePrefab);
+      entity.set<PositionCD>(PositionCD(transform.pos));
+      entity.set<RotationCD>(RotationCD(transform.rot));
+      if (has_texture) {
+        entity.set<TextureCD>(tex);
+        entity.set<MeshCD>(model);
+      }
+
+      StaticBodyCD body;
+      body.rigid = px.Physics()->createRigidStatic(
+        PxUtil::ToTransform(transform.pos, transform.rot));
+      body.rigid->attachShape(*box);
+      PxCDHelper::BindEntity(*body.rigid, entity);
+      entity.set<PxShapeCD>({box});
+      entity.set<StaticBodyCD>(body);
+
+      actors.push_back(body.rigid);
+      entities << entity;
+    }
+    world.defer_end();
+
+    // 生成時の参照を手放す（以降はアタッチしたActorが保持する）
+    box->release();
+
+    AddBodies(world, px, actors, aggregate_size, true);
+    return entities;
+  }
+
+  // 動的な球をまとめて生成する
+  // 形状とメッシュは全インスタンスで共有し、aggregate_size個ずつPxAggregateにまとめて追加する
+  // aggregate_sizeが0の場合はAggregateを使わず、シーンへ1回の呼び出しで追加する
+  static Array<flecs::entity> DynamicSpheres(
+    flecs::world& world, std::span<const SpawnTransform> transforms,
+    float radius = 0.5f, const Color& color = Palette::White,
+    uint32 aggregate_size = kDefaultAggregateSize) {
+    Array<flecs::entity> entities;
+    if (transforms.empty()) {
+      return entities;
+    }
+    entities.reserve(transforms.size());
+
+    assert(world.has<PxDataSingletonCD>());
+    PxDataSingletonCD& px = *world.get_ref<PxDataSingletonCD>().get();
+
+    physx::PxShape* sphere = px.Physics()->createShape(
+      physx::PxSphereGeometry(radius), *px.GetDefaultMat(), false);
+    const MeshCD model = {GetSphereMesh(radius)};
+
+    std::vector<physx::PxActor*> actors;
+    actors.reserve(transforms.size());
+
+    // 構造変更はまとめて反映する
+    world.defer_begin();
+    for (const auto& transform : transforms) {
+      auto entity = world.entity();
+      entity.is_a(s_dynamicSpherePrefab);
+      entity.set<PositionCD>(PositionCD(transform.pos));
+      entity.set<RotationCD>(RotationCD(transform.rot));
+      entity.set<MeshCD>(model);
+      entity.set<ColorCD>(ColorCD(color));
+
+      DynamicBodyCD body;
+      body.rigid = px.Physics()->createRigidDynamic(
+        PxUtil::ToTransform(transform.pos, transform.rot));
+      body.rigid->attachShape(*sphere);
+      PxCDHelper::BindEntity(*body.rigid, entity);
+      entity.set<PxShapeCD>({sphere});
+      entity.set<DynamicBodyCD>(body);
+      entity.set<PxInterpolationCD>({body.rigid->getGlobalPose()});
+
+      actors.push_back(body.rigid);
+      entities << entity;
+    }
+    world.defer_end();
+
+    // 生成時の参照を手放す（以降はアタッチしたActorが保持する）
+    sphere->release();
+
+    AddBodies(world, px, actors, aggregate_size, false);
+    return entities;
+  }
+
   static flecs::entity StandardFont(flecs::world& world, int32 font_size = 48,
                                     FontMethod font_method = FontMethod::MSDF,
                                     Typeface typeface = Typeface::Regular) {
@@ -231,8 +365,10 @@ class EntityFactory {
     entity.set<Rotation2DCD>(Rotation2DCD(rotation));
     entity.set<ScalarScaleCD>(ScalarScaleCD(scale));
 
-    TextureCD texture = Texture(emoji, TextureDesc::MippedSRGB);
-    entity.set<TextureCD>(texture);
+    auto& atlas = world.ensure<SpriteAtlasSingletonCD>().atlas;
+    if (const auto region = atlas.Load(emoji)) {
+      entity.set<SpriteRegionCD>({region->texture, region->rect});
+    }
 
     return entity;
   }
@@ -249,8 +385,10 @@ class EntityFactory {
     entity.set<Rotation2DCD>(Rotation2DCD(rotation));
     entity.set<ScalarScaleCD>(ScalarScaleCD(scale));
 
-    TextureCD texture = Texture(texture_path, TextureDesc::MippedSRGB);
-    entity.set<TextureCD>(texture);
+    auto& atlas = world.ensure<SpriteAtlasSingletonCD>().atlas;
+    if (const auto region = atlas.Load(texture_path)) {
+      entity.set<SpriteRegionCD>({region->texture, region->rect});
+    }
 
     return entity;
   }
@@ -267,12 +405,26 @@ class EntityFactory {
     entity.set<Rotation2DCD>(Rotation2DCD(rotation));
     entity.set<Size2DCD>(Size2DCD(size));
 
-    TextureCD texture = Texture(texture_path, TextureDesc::MippedSRGB);
-    entity.set<TextureCD>(texture);
+    auto& atlas = world.ensure<SpriteAtlasSingletonCD>().atlas;
+    if (const auto region = atlas.Load(texture_path)) {
+      entity.set<SpriteRegionCD>({region->texture, region->rect});
+    }
 
     return entity;
   }
 
+  // childをparentの子にし、parentから見た相対姿勢を設定する
+  // 以降childのPositionCD/RotationCDはTransformSystemが毎フレーム求める
+  static flecs::entity AttachChild(
+    flecs::entity child, flecs::entity parent, const Vec3& local_pos,
+    const Quaternion& local_rot = Quaternion::Identity()) {
+    child.child_of(parent);
+    child.set<LocalTransformCD>(LocalTransformCD(local_pos, local_rot));
+    child.add<PositionCD>();
+    child.add<RotationCD>();
+    return child;
+  }
+
   // スプライトアニメーション用エンティティ作成関数
   static flecs::entity SpriteAnimation(
     flecs::world& world, const std::vector<FilePath>& texture_paths,
@@ -286,27 +438,70 @@ class EntityFactory {
     entity.set<Rotation2DCD>(Rotation2DCD(rotation));
     entity.set<ScalarScaleCD>(ScalarScaleCD(scale));
 
-    // テクスチャ配列を作成
-    std::vector<Texture> textures;
-    textures.reserve(texture_paths.size());
-
+    // フレームをアトラスに詰め込む（同じパスのフレームは他のアニメーションとも共有される）
+    auto& atlas = world.ensure<SpriteAtlasSingletonCD>().atlas;
+    AtlasFrameArrayCD frames;
+    frames.frames.reserve(texture_paths.size());
     for (const auto& path : texture_paths) {
-      textures.emplace_back(Texture(path, TextureDesc::MippedSRGB));
+      if (const auto region = atlas.Load(path)) {
+        frames.frames.push_back({region->texture, region->rect});
+      }
     }
 
     // アニメーション関連コンポーネントを設定
     entity.set<SpriteAnimationCD>(SpriteAnimationCD(interval, loop));
-    entity.set<TextureArrayCD>(TextureArrayCD(textures));
     entity.set<FrameCD>(FrameCD(0));
-    entity.set<TimerCD>(TimerCD(0.0));
 
-    // 最初のフレームのテクスチャを設定
-    auto* tex_cd = entity.try_get_mut<TextureCD>();
-    if (tex_cd) {
-      tex_cd->tex = textures.front();
+    // 最初のフレームの領域を設定
+    if (!frames.frames.empty()) {
+      entity.set<SpriteRegionCD>(
+        {frames.frames.front().atlas, frames.frames.front().region});
     }
+    entity.set<AtlasFrameArrayCD>(std::move(frames));
 
     return entity;
   }
 
+  private:
+  // 同じ形状のメッシュ・同じパスのテクスチャはAssetCacheで共有し、GPUへ1回だけ送る
+  static Mesh GetSphereMesh(float radius) {
+    return AssetCache::GetSphereMesh(radius);
+  }
+
+  static Mesh GetBoxMesh(const Vec3& size) {
+    return AssetCache::GetBoxMesh(size);
+  }
+
+  static Texture GetTexture(FilePathView path) {
+    return AssetCache::GetTexture(path, TextureDesc::MippedSRGB);
+  }
+
+  // 生成したActorをシーンへ追加する
+  // aggregate_sizeが0なら1回のaddActors、そうでなければaggregate_size個ずつAggregateにまとめて追加
+  static void AddBodies(flecs::world& world, PxDataSingletonCD& px,
+                        std::span<physx::PxActor* const> actors,
+                        uint32 aggregate_size, bool is_static) {
+    if (aggregate_size == 0) {
+      px.AddActors(world, actors);
+      return;
+    }
+
+    // 静的なActor同士は衝突しないため自己衝突は不要
+    const physx::PxAggregateFilterHint filter_hint =
+      physx::PxGetAggregateFilterHint(is_static
+                                        ? physx::PxAggregateType::eSTATIC
+                                        : physx::PxAggregateType::eGENERIC,
+                                      !is_static);
+    for (size_t begin = 0; begin < actors.size(); begin += aggregate_size) {
+      const uint32 count = static_cast<uint32>(
+        Min<size_t>(aggregate_size, actors.size() - begin));
+      physx::PxAggregate* aggregate =
+        px.Physics()->createAggregate(count, count, filter_hint);
+      for (uint32 i = 0; i < count; ++i) {
+        aggregate->addActor(*actors[begin + i]);
+      }
+      px.AddAggregate(world, *aggregate);
+    }
+  }
+
 };  // class EntityFactory
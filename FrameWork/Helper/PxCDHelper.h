@@ -23,6 +23,11 @@ void InitializeRemoveBodyObserver(flecs::world& world) {
     });
 }
 
+// ActorのuserDataにエンティティIDを設定（PxDataSingletonCD::AddActorの前に呼ぶ）
+void BindEntity(physx::PxActor& actor, flecs::entity entity) {
+  PxUtil::SetUserId(actor, entity.id());
+}
+
 void InitStatic(PxDataSingletonCD& px, StaticBodyCD& s_body_cd,
                 PxShapeCD& shape_cd, physx::PxShape* shape) {
   s_body_cd.rigid =
@@ -68,4 +73,19 @@ void ToPosRot(const physx::PxTransform& transform, PositionCD& pos_cd,
     Quaternion(transform.q.x, transform.q.y, transform.q.z, transform.q.w);
 }
 
+// 2つの姿勢をalpha(0～1)で補間して位置と回転に変換
+void ToPosRotInterpolated(const physx::PxTransform& previous,
+                          const physx::PxTransform& current, float alpha,
+                          PositionCD& pos_cd, RotationCD& rot_cd) {
+  const Vec3 prev_pos = PxUtil::ToSivVec(previous.p);
+  const Vec3 curr_pos = PxUtil::ToSivVec(current.p);
+  pos_cd.pos = prev_pos.lerp(curr_pos, alpha);
+
+  const Quaternion prev_rot(previous.q.x, previous.q.y, previous.q.z,
+                            previous.q.w);
+  const Quaternion curr_rot(current.q.x, current.q.y, current.q.z,
+                            current.q.w);
+  rot_cd.rot = prev_rot.slerp(curr_rot, alpha);
+}
+
 }  // namespace PxCDHelper
@@ -1,6 +1,7 @@
 ﻿// LlamaConfig.h
 #pragma once
 #include <Siv3D.hpp>
+#include <vector>
 
 #include "llama.h"
 
@@ -22,6 +23,24 @@ struct ContextConfig {
   uint32_t batch_size = 512;     // バッチサイズ
   int32_t threads = 0;           // スレッド数（0=自動）
   int32_t threads_batch = 0;     // バッチ処理用スレッド数（0=自動）
+
+  // コンテキストプールのキー比較用
+  bool operator==(const ContextConfig&) const = default;
+};
+
+// サンプラーの種類（SamplingConfig::chainで適用順を指定する）
+enum class SamplerType {
+  kGreedy,       // 最大ロジットのトークンを選ぶ（選択段）
+  kTopK,         // 上位top_k個に絞る
+  kTopP,         // 累積確率top_pまでに絞る
+  kMinP,         // 最大確率のmin_p倍未満を除外する
+  kTypical,      // Locally Typical Sampling
+  kTemperature,  // 温度を適用する
+  kPenalties,    // 繰り返し・頻度・存在ペナルティ
+  kLogitBias,    // 指定トークンのロジットにバイアスを加える
+  kMirostat,     // Mirostat 1.0（選択段）
+  kMirostatV2,   // Mirostat 2.0（選択段）
+  kDist          // 確率分布に従って選ぶ（選択段）
 };
 
 // サンプリング設定構造体
@@ -30,6 +49,26 @@ struct SamplingConfig {
   float top_p = 0.9f;                  // Top-Pサンプリング値
   float temperature = 0.7f;            // 温度パラメータ
   uint32_t seed = LLAMA_DEFAULT_SEED;  // 乱数シード
+
+  // サンプラーチェーンの適用順
+  // 空の場合は top_k → top_p → temperature → dist（temperatureが0以下ならgreedyのみ）
+  // 末尾が選択段（greedy, mirostat, dist）でない場合はdistが追加される
+  std::vector<SamplerType> chain;
+
+  float min_p = 0.05f;     // Min-Pサンプリング値
+  float typical_p = 1.0f;  // Typicalサンプリング値（1.0=無効）
+  size_t min_keep = 1;     // 各フィルタで最低限残す候補数
+
+  int32_t penalty_last_n = 64;   // ペナルティ対象とする直近トークン数（-1=コンテキスト長）
+  float penalty_repeat = 1.0f;   // 繰り返しペナルティ（1.0=無効）
+  float penalty_freq = 0.0f;     // 頻度ペナルティ（0.0=無効）
+  float penalty_present = 0.0f;  // 存在ペナルティ（0.0=無効）
+
+  std::vector<llama_logit_bias> logit_biases;  // トークンごとのロジットバイアス
+
+  float mirostat_tau = 5.0f;  // Mirostatの目標サプライズ値
+  float mirostat_eta = 0.1f;  // Mirostatの学習率
+  int32_t mirostat_m = 100;   // Mirostat 1.0の推定に使う候補数
 };
 
 // LLMリクエスト構造体
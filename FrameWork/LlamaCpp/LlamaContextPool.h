@@ -0,0 +1,215 @@
+﻿// LlamaContextPool.h
+#pragma once
+#include <Siv3D.hpp>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "LlamaComponents.h"
+#include "LlamaContext.h"
+#include "LlamaModel.h"
+
+namespace llama_cpp {
+
+// LlamaContextの再利用プール
+// (モデル, ContextConfig) ごとに解放済みコンテキストを保持し、
+// フェーズ切り替えのたびにコンテキストとバッファを確保し直さないようにする
+class LlamaContextPool {
+  public:
+  // シングルトンアクセス
+  static LlamaContextPool& GetInstance();
+
+  // コンテキストを取得する（プールに空きがなければ新規作成）
+  // 返すコンテキストはメモリ（KVキャッシュ）がクリア済み
+  std::unique_ptr<LlamaContext> Acquire(std::shared_ptr<LlamaModel> model,
+                                        const ContextConfig& config);
+
+  // コンテキストをプールへ返却する（メモリはクリアされる）
+  void Release(std::shared_ptr<LlamaModel> model, const ContextConfig& config,
+               std::unique_ptr<LlamaContext> context);
+
+  // 事前にコンテキストを確保しておく（起動時のロード画面などで呼ぶ想定）
+  // プール内の空きがcount個になるまで作成する
+  bool Prewarm(std::shared_ptr<LlamaModel> model, const ContextConfig& config,
+               size_t count = 1);
+
+  // プール内の空きコンテキスト数を取得
+  size_t GetIdleCount(const std::shared_ptr<LlamaModel>& model,
+                      const ContextConfig& config) const;
+
+  // 指定したモデルのコンテキストを全て解放する（LlamaModelManager::ReleaseModelから呼ばれる）
+  // プールが保持するモデルの参照もここで手放す
+  void ReleaseModel(const LlamaModel* model);
+
+  // 全コンテキストの解放（LlamaModelManager::ReleaseAllModelsから呼ばれる）
+  void ReleaseAll();
+
+  private:
+  // プールのエントリ（キーごとの空きコンテキスト）
+  struct PoolEntry {
+    std::shared_ptr<LlamaModel> model;  // コンテキストより先にモデルが解放されないよう保持
+    ContextConfig config;
+    std::vector<std::unique_ptr<LlamaContext>> idle_contexts;
+  };
+
+  // プライベートコンストラクタ（シングルトン）
+  LlamaContextPool() = default;
+  ~LlamaContextPool() = default;
+
+  // コピー・ムーブ禁止
+  LlamaContextPool(const LlamaContextPool&) = delete;
+  LlamaContextPool& operator=(const LlamaContextPool&) = delete;
+  LlamaContextPool(LlamaContextPool&&) = delete;
+  LlamaContextPool& operator=(LlamaContextPool&&) = delete;
+
+  // キーに対応するエントリを検索（見つからなければnullptr）
+  // キー数はごく少数なので線形探索で十分
+  PoolEntry* FindEntry(const LlamaModel* model, const ContextConfig& config);
+  const PoolEntry* FindEntry(const LlamaModel* model,
+                             const ContextConfig& config) const;
+
+  // コンテキストのメモリをクリアする
+  static void ClearMemory(LlamaContext& context);
+
+  mutable std::mutex pool_mutex_;
+  std::vector<PoolEntry> entries_;
+};
+
+// インライン実装
+inline LlamaContextPool& LlamaContextPool::GetInstance() {
+  // staticなSisterMessageUIManagerなどが保持するジェネレータの破棄時にも
+  // 返却先が生きているよう、意図的に破棄しない
+  static LlamaContextPool* instance = new LlamaContextPool();
+  return *instance;
+}
+
+inline std::unique_ptr<LlamaContext> LlamaContextPool::Acquire(
+  std::shared_ptr<LlamaModel> model, const ContextConfig& config) {
+  if (!model || !model->IsValid()) {
+    return nullptr;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    if (auto* entry = FindEntry(model.get(), config)) {
+      if (!entry->idle_contexts.empty()) {
+        auto context = std::move(entry->idle_contexts.back());
+        entry->idle_contexts.pop_back();
+        return context;
+      }
+    }
+  }
+
+  // 空きがなければ新規作成（ロック外で行い、作成中に他スレッドを止めない）
+  auto context_result = LlamaContext::Create(*model, config);
+  if (!context_result) {
+    return nullptr;
+  }
+
+#ifdef _DEBUG
+  s3d::Console << U"LlamaContextPool: コンテキストを新規作成しました (n_ctx="
+               << config.context_size << U")";
+#endif
+  return std::make_unique<LlamaContext>(std::move(*context_result));
+}
+
+inline void LlamaContextPool::Release(std::shared_ptr<LlamaModel> model,
+                                      const ContextConfig& config,
+                                      std::unique_ptr<LlamaContext> context) {
+  if (!model || !context || !context->IsValid()) {
+    return;
+  }
+
+  // 次の利用者のために会話履歴を消しておく
+  ClearMemory(*context);
+
+  std::lock_guard<std::mutex> lock(pool_mutex_);
+  if (auto* entry = FindEntry(model.get(), config)) {
+    entry->idle_contexts.push_back(std::move(context));
+    return;
+  }
+
+  PoolEntry entry;
+  entry.model = std::move(model);
+  entry.config = config;
+  entry.idle_contexts.push_back(std::move(context));
+  entries_.push_back(std::move(entry));
+}
+
+inline bool LlamaContextPool::Prewarm(std::shared_ptr<LlamaModel> model,
+                                      const ContextConfig& config,
+                                      size_t count) {
+  if (!model || !model->IsValid()) {
+    return false;
+  }
+
+  while (GetIdleCount(model, config) < count) {
+    auto context_result = LlamaContext::Create(*model, config);
+    if (!context_result) {
+      return false;
+    }
+    Release(model, config,
+            std::make_unique<LlamaContext>(std::move(*context_result)));
+  }
+  return true;
+}
+
+inline size_t LlamaContextPool::GetIdleCount(
+  const std::shared_ptr<LlamaModel>& model, const ContextConfig& config) const {
+  std::lock_guard<std::mutex> lock(pool_mutex_);
+  if (const auto* entry = FindEntry(model.get(), config)) {
+    return entry->idle_contexts.size();
+  }
+  return 0;
+}
+
+inline void LlamaContextPool::ReleaseModel(const LlamaModel* model) {
+  // コンテキストとモデルの解放はロック外で行う
+  std::vector<PoolEntry> released;
+  {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      if (it->model.get() == model) {
+        released.push_back(std::move(*it));
+        it = entries_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+}
+
+inline void LlamaContextPool::ReleaseAll() {
+  std::vector<PoolEntry> released;
+  {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    released.swap(entries_);
+  }
+}
+
+inline LlamaContextPool::PoolEntry* LlamaContextPool::FindEntry(
+  const LlamaModel* model, const ContextConfig& config) {
+  for (auto& entry : entries_) {
+    if (entry.model.get() == model && entry.config == config) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+inline const LlamaContextPool::PoolEntry* LlamaContextPool::FindEntry(
+  const LlamaModel* model, const ContextConfig& config) const {
+  for (const auto& entry : entries_) {
+    if (entry.model.get() == model && entry.config == config) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+inline void LlamaContextPool::ClearMemory(LlamaContext& context) {
+  llama_memory_t memory = llama_get_memory(context.GetRawContext());
+  llama_memory_clear(memory, true);  // dataも含めてクリア
+}
+
+}  // namespace llama_cpp
@@ -6,6 +6,7 @@
 #include <unordered_map>
 
 #include "LlamaComponents.h"
+#include "LlamaContextPool.h"
 #include "LlamaModel.h"
 
 namespace llama_cpp {
@@ -28,9 +29,10 @@ class LlamaModelManager {
   bool IsModelInitialized(const s3d::String& model_id) const;
 
   // モデルの解放（明示的な削除）
+  // LlamaContextPoolに残っているそのモデルのコンテキストも解放する
   void ReleaseModel(const s3d::String& model_id);
 
-  // 全モデルの解放
+  // 全モデルの解放（プールのコンテキストも全て解放する）
   void ReleaseAllModels();
 
   // 初期化済みモデル一覧の取得
@@ -126,6 +128,8 @@ inline void LlamaModelManager::ReleaseModel(const s3d::String& model_id) {
 
   auto it = models_.find(model_id);
   if (it != models_.end()) {
+    // プールがモデルを保持したままだと解放されないため、先にコンテキストを手放させる
+    LlamaContextPool::GetInstance().ReleaseModel(it->second.get());
     s3d::Console << U"LlamaModelManager: モデル '" << model_id
                << U"' を解放しました";
     models_.erase(it);
@@ -137,6 +141,7 @@ inline void LlamaModelManager::ReleaseAllModels() {
 
   s3d::Console << U"LlamaModelManager: 全モデル（" << models_.size()
              << U"個）を解放します";
+  LlamaContextPool::GetInstance().ReleaseAll();
   models_.clear();
 }
 
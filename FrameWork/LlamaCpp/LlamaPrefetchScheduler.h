@@ -0,0 +1,183 @@
+﻿// LlamaPrefetchScheduler.h
+#pragma once
+#include <Siv3D.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#ifdef _WIN32
+// Siv3Dと衝突しないマクロ設定でWindows.hを読み込む
+#include <Siv3D/Windows/Windows.hpp>
+#endif
+
+#include "Util/FrameProfiler.h"
+
+namespace llama_cpp {
+
+// LLMの先読み処理（システムプロンプトのプリフィルなど）を低優先度で実行するスケジューラー
+// 専用のワーカースレッド（OSのスレッド優先度を下げてある）でタスクを1つずつ実行し、
+// 対話的な生成リクエストが来ている間は新しいタスクを開始せず、実行中のタスクにも中断を促す
+class LlamaPrefetchScheduler {
+  public:
+  // 先読みタスク
+  // 完了（または続行不要）ならtrue、ShouldYield()により中断した場合はfalseを返す
+  // falseを返したタスクは対話的な生成が終わった後に再実行される
+  using Task = std::function<bool()>;
+
+  // 対話的な生成の実行中を示すRAIIスコープ
+  // このスコープが生きている間、先読みタスクは中断・待機する
+  class InteractiveScope {
+    public:
+    InteractiveScope() { LlamaPrefetchScheduler::GetInstance().BeginInteractive(); }
+    ~InteractiveScope() { LlamaPrefetchScheduler::GetInstance().EndInteractive(); }
+
+    InteractiveScope(const InteractiveScope&) = delete;
+    InteractiveScope& operator=(const InteractiveScope&) = delete;
+  };
+
+  // シングルトンアクセス
+  // 生成スレッド上のInteractiveScopeが静的オブジェクト破棄後に動くことがあるため、
+  // インスタンスは意図的に破棄しない（ワーカーの停止はShutdown()で行う）
+  static LlamaPrefetchScheduler& GetInstance() {
+    static LlamaPrefetchScheduler* instance = new LlamaPrefetchScheduler();
+    return *instance;
+  }
+
+  // タスクを追加する
+  // 同じキーのタスクが待機中の場合は新しいタスクで置き換える
+  void Enqueue(const s3d::String& key, Task task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (auto& entry : queue_) {
+        if (entry.key == key) {
+          entry.task = std::move(task);
+          return;
+        }
+      }
+      queue_.push_back({key, std::move(task)});
+    }
+    condition_.notify_one();
+  }
+
+  // 待機中のタスクをすべて破棄する（実行中のタスクは完了まで実行される）
+  void CancelAll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.clear();
+  }
+
+  // 実行中のタスクが中断すべきかどうか
+  // タスクはチャンクの切れ目などでこれを確認し、trueなら速やかにfalseを返す
+  bool ShouldYield() const {
+    return interactive_count_.load() > 0 || stop_.load();
+  }
+
+  // 対話的な生成の開始・終了を通知する（通常はInteractiveScopeを使う）
+  void BeginInteractive() { ++interactive_count_; }
+  void EndInteractive() {
+    if (--interactive_count_ == 0) {
+      // 待機側の条件判定と競合しないようロックを経由して通知する
+      { std::lock_guard<std::mutex> lock(mutex_); }
+      condition_.notify_one();
+    }
+  }
+
+  // ワーカースレッドを停止する（アプリ終了時に一度呼ぶ）
+  // 実行中のタスクにはShouldYield()で中断を促し、終了を待つ
+  void Shutdown() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+      queue_.clear();
+    }
+    condition_.notify_one();
+    if (worker_.joinable()) {
+      worker_.join();
+    }
+  }
+
+  // 待機中・実行中のタスクがないかどうか
+  bool IsIdle() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.empty() && !is_running_task_;
+  }
+
+  private:
+  // キー付きのタスク
+  struct Entry {
+    s3d::String key;
+    Task task;
+  };
+
+  // プライベートコンストラクタ（シングルトン）
+  LlamaPrefetchScheduler() : worker_([this] { WorkerLoop(); }) {}
+  ~LlamaPrefetchScheduler() = default;
+
+  // コピー・ムーブ禁止
+  LlamaPrefetchScheduler(const LlamaPrefetchScheduler&) = delete;
+  LlamaPrefetchScheduler& operator=(const LlamaPrefetchScheduler&) = delete;
+  LlamaPrefetchScheduler(LlamaPrefetchScheduler&&) = delete;
+  LlamaPrefetchScheduler& operator=(LlamaPrefetchScheduler&&) = delete;
+
+  // ワーカースレッドの処理
+  void WorkerLoop() {
+    FrameProfiler::SetThreadName("llm_prefetch");
+    LowerThreadPriority();
+    while (true) {
+      Entry entry;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // タスクがあり、対話的な生成が行われていないときだけ起きる
+        condition_.wait(lock, [this] {
+          return stop_.load() || (!queue_.empty() && interactive_count_.load() == 0);
+        });
+        if (stop_) {
+          return;
+        }
+        entry = std::move(queue_.front());
+        queue_.pop_front();
+        is_running_task_ = true;
+      }
+
+      bool completed;
+      {
+        const FrameProfiler::Scope scope{"LlamaPrefetch::task"};
+        completed = entry.task();
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_running_task_ = false;
+        // 中断されたタスクは、同じキーの新しいタスクが積まれていなければ先頭に戻す
+        if (!completed && !stop_) {
+          bool replaced = false;
+          for (const auto& queued : queue_) {
+            replaced = replaced || (queued.key == entry.key);
+          }
+          if (!replaced) {
+            queue_.push_front(std::move(entry));
+          }
+        }
+      }
+    }
+  }
+
+  // 呼び出したスレッドの優先度を下げる（メインスレッドや対話的な生成にCPUを譲る）
+  static void LowerThreadPriority() {
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+#endif
+  }
+
+  mutable std::mutex mutex_;
+  std::condition_variable condition_;
+  std::deque<Entry> queue_;                  // 待機中のタスク
+  bool is_running_task_ = false;             // タスク実行中フラグ
+  std::atomic<int> interactive_count_{0};    // 実行中の対話的な生成の数
+  std::atomic<bool> stop_{false};            // 終了要求フラグ
+  std::thread worker_;                       // ワーカースレッド（最後に初期化する）
+};
+
+}  // namespace llama_cpp
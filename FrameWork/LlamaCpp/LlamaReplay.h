@@ -0,0 +1,137 @@
+﻿// LlamaReplay.h
+#pragma once
+#include <Siv3D.hpp>
+#include <mutex>
+#include <vector>
+
+namespace llama_cpp {
+
+// LLMの応答を記録・再生するクラス
+// 記録モードでは実際の生成結果をチャンネル（呼び出し元の種類）ごとに保存し、
+// 再生モードではモデルを使わずに記録済みの応答を返す（回帰テストやヘッドレス実行用）
+// ファイル形式:
+//   { "entries": [ { "channel": "job_search", "prompt": "...", "response": "40" }, ... ] }
+// 例:
+//   LlamaReplay::LoadReplay(U"LlmReplay/playthrough.json");
+//   if (LlamaReplay::IsReplaying()) { buffer.CompleteWith(LlamaReplay::Find(U"job_search", prompt)); }
+class LlamaReplay {
+  public:
+  enum class Mode {
+    kOff,     // 通常の生成
+    kRecord,  // 生成結果を記録する
+    kReplay,  // 記録済みの応答を返す
+  };
+
+  LlamaReplay() = delete;
+
+  // 記録を開始する（記録済みの内容は破棄する）
+  static void StartRecording() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    channel_cursors_.clear();
+    mode_ = Mode::kRecord;
+  }
+
+  // 記録ファイルを読み込んで再生モードにする
+  static bool LoadReplay(const s3d::FilePath& path) {
+    const s3d::JSON json = s3d::JSON::Load(path);
+    if (!json || !json[U"entries"].isArray()) {
+      s3d::Console << U"LlamaReplay: 記録ファイルを読み込めません: " << path;
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    channel_cursors_.clear();
+    for (const auto& entry : json[U"entries"].arrayView()) {
+      entries_.push_back(Entry{entry[U"channel"].getString(), entry[U"prompt"].getString(),
+                               entry[U"response"].getString()});
+    }
+    mode_ = Mode::kReplay;
+    return true;
+  }
+
+  // 記録した内容をファイルに保存する
+  static bool Save(const s3d::FilePath& path) {
+    s3d::JSON json;
+    json[U"entries"] = s3d::Array<s3d::JSON>{};
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (const auto& entry : entries_) {
+        s3d::JSON item;
+        item[U"channel"] = entry.channel;
+        item[U"prompt"] = entry.prompt;
+        item[U"response"] = entry.response;
+        json[U"entries"].push_back(item);
+      }
+    }
+    if (!json.save(path)) {
+      s3d::Console << U"LlamaReplay: 記録ファイルを保存できません: " << path;
+      return false;
+    }
+    return true;
+  }
+
+  static void Stop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    mode_ = Mode::kOff;
+  }
+
+  [[nodiscard]] static Mode GetMode() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return mode_;
+  }
+
+  [[nodiscard]] static bool IsRecording() { return GetMode() == Mode::kRecord; }
+  [[nodiscard]] static bool IsReplaying() { return GetMode() == Mode::kReplay; }
+
+  // 生成結果を記録する（記録モード以外では何もしない）
+  static void Record(s3d::StringView channel, const s3d::String& prompt,
+                     const s3d::String& response) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (mode_ != Mode::kRecord) {
+      return;
+    }
+    entries_.push_back(Entry{s3d::String{channel}, prompt, response});
+  }
+
+  // 記録済みの応答を探す
+  // 同じチャンネル・同じプロンプトの記録があればそれを返し、
+  // なければそのチャンネルの記録を先頭から順番に返す（末尾まで使ったら先頭に戻る）
+  // チャンネルの記録が1件もなければ空文字列を返す
+  [[nodiscard]] static s3d::String Find(s3d::StringView channel, const s3d::String& prompt) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<const Entry*> candidates;
+    for (const auto& entry : entries_) {
+      if (entry.channel != channel) {
+        continue;
+      }
+      if (entry.prompt == prompt) {
+        return entry.response;
+      }
+      candidates.push_back(&entry);
+    }
+    if (candidates.empty()) {
+      return s3d::String{};
+    }
+
+    size_t& cursor = channel_cursors_[s3d::String{channel}];
+    const Entry& entry = *candidates[cursor % candidates.size()];
+    ++cursor;
+    return entry.response;
+  }
+
+  private:
+  struct Entry {
+    s3d::String channel;
+    s3d::String prompt;
+    s3d::String response;
+  };
+
+  static inline std::mutex mutex_;
+  static inline Mode mode_ = Mode::kOff;
+  static inline std::vector<Entry> entries_;
+  static inline s3d::HashTable<s3d::String, size_t> channel_cursors_;  // チャンネルごとの次に返す記録
+};
+
+}  // namespace llama_cpp
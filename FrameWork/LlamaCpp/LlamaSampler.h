@@ -1,5 +1,7 @@
 ﻿// LlamaSampler.h
 #pragma once
+#include <vector>
+
 #include "LlamaComponents.h"
 
 namespace llama_cpp {
@@ -8,7 +10,10 @@ namespace llama_cpp {
 class LlamaSampler {
   public:
   // ファクトリーメソッド
-  static Result<LlamaSampler> Create(const SamplingConfig& config) {
+  // config.chainの順にサンプラーを積む（空の場合は従来の top_k → top_p → temp → dist）
+  // logit_biasやmirostatは語彙数が必要なため、使用する場合はvocabを渡す
+  static Result<LlamaSampler> Create(const SamplingConfig& config,
+                                     const llama_vocab* vocab = nullptr) {
     auto sampler_params = llama_sampler_chain_default_params();
     sampler_params.no_perf = false;
 
@@ -21,17 +26,22 @@ class LlamaSampler {
       return Result<LlamaSampler>::Error(LlamaError::kSamplerCreateFailed);
     }
 
+    const std::vector<SamplerType> chain = ResolveChain(config);
+    const int32_t n_vocab = vocab ? llama_vocab_n_tokens(vocab) : 0;
+
     // サンプリング戦略の追加
-    llama_sampler_chain_add(sampler.get(),
-                            llama_sampler_init_top_k(config.top_k));
-    llama_sampler_chain_add(sampler.get(),
-                            llama_sampler_init_top_p(config.top_p, 1));
-    llama_sampler_chain_add(sampler.get(),
-                            llama_sampler_init_temp(config.temperature));
-    llama_sampler_chain_add(sampler.get(),
-                            llama_sampler_init_dist(config.seed));
-
-    return Result<LlamaSampler>::Ok(LlamaSampler(std::move(sampler)));
+    for (const SamplerType type : chain) {
+      llama_sampler* stage = CreateStage(type, config, n_vocab);
+      if (!stage) {
+        s3d::Console << U"LlamaSampler: サンプラー段の作成に失敗しました (type="
+                     << static_cast<int32>(type) << U")";
+        return Result<LlamaSampler>::Error(LlamaError::kSamplerCreateFailed);
+      }
+      llama_sampler_chain_add(sampler.get(), stage);
+    }
+
+    return Result<LlamaSampler>::Ok(
+      LlamaSampler(std::move(sampler), IsPureGreedy(chain)));
   }
 
   // コピー禁止、ムーブ可能
@@ -40,16 +50,134 @@ class LlamaSampler {
   LlamaSampler(LlamaSampler&&) = default;
   LlamaSampler& operator=(LlamaSampler&&) = default;
 
+  // 次のトークンをサンプリングする
+  // 純粋なgreedyチェーンの場合は候補配列の構築・ソート・softmaxを行わず、ロジットから直接argmaxを求める
+  llama_token Sample(llama_context* ctx, int32_t idx = -1) const {
+    if (is_pure_greedy_) {
+      const llama_vocab* vocab = llama_model_get_vocab(llama_get_model(ctx));
+      return ArgMax(llama_get_logits_ith(ctx, idx), llama_vocab_n_tokens(vocab));
+    }
+    return llama_sampler_sample(sampler_.get(), ctx, idx);
+  }
+
+  // ペナルティやmirostatなどの内部状態をリセットする（生成開始時に呼ぶ）
+  void Reset() const { llama_sampler_reset(sampler_.get()); }
+
+  // ロジット配列の最大値のインデックスを返す
+  static llama_token ArgMax(const float* logits, int32_t n_vocab) {
+    llama_token best = 0;
+    float best_logit = logits[0];
+    for (int32_t i = 1; i < n_vocab; ++i) {
+      if (logits[i] > best_logit) {
+        best_logit = logits[i];
+        best = i;
+      }
+    }
+    return best;
+  }
+
   // アクセサ
   llama_sampler* GetRawSampler() const { return sampler_.get(); }
   bool IsValid() const { return sampler_.get() != nullptr; }
+  bool IsPureGreedy() const { return is_pure_greedy_; }
 
   private:
   explicit LlamaSampler(
-    std::unique_ptr<llama_sampler, decltype(&llama_sampler_free)> sampler)
-      : sampler_(std::move(sampler)) {}
+    std::unique_ptr<llama_sampler, decltype(&llama_sampler_free)> sampler,
+    bool is_pure_greedy)
+      : sampler_(std::move(sampler)), is_pure_greedy_(is_pure_greedy) {}
+
+  // 設定から実際に積むサンプラーの並びを決める
+  static std::vector<SamplerType> ResolveChain(const SamplingConfig& config) {
+    std::vector<SamplerType> chain = config.chain;
+    if (chain.empty()) {
+      if (config.temperature <= 0.0f) {
+        chain = {SamplerType::kGreedy};
+      } else {
+        chain = {SamplerType::kTopK, SamplerType::kTopP,
+                 SamplerType::kTemperature, SamplerType::kDist};
+      }
+    }
+
+    // 選択段で終わらないチェーンはトークンが決まらないためdistを補う
+    if (!IsSelector(chain.back())) {
+      chain.push_back(SamplerType::kDist);
+    }
+    return chain;
+  }
+
+  // トークンを最終的に選ぶ段かどうか
+  static bool IsSelector(SamplerType type) {
+    return type == SamplerType::kGreedy || type == SamplerType::kMirostat ||
+           type == SamplerType::kMirostatV2 || type == SamplerType::kDist;
+  }
+
+  // 結果がロジットのargmaxと一致するチェーンかどうか
+  // top_k/top_p/min_p/temperatureは最大ロジットのトークンを必ず残すため、greedyの前にあっても結果は変わらない
+  static bool IsPureGreedy(const std::vector<SamplerType>& chain) {
+    if (chain.back() != SamplerType::kGreedy) {
+      return false;
+    }
+    for (size_t i = 0; i + 1 < chain.size(); ++i) {
+      switch (chain[i]) {
+        case SamplerType::kTopK:
+        case SamplerType::kTopP:
+        case SamplerType::kMinP:
+        case SamplerType::kTemperature:
+          break;
+        default:
+          return false;
+      }
+    }
+    return true;
+  }
+
+  // サンプラー段を1つ作成する（失敗時はnullptr）
+  static llama_sampler* CreateStage(SamplerType type, const SamplingConfig& config,
+                                    int32_t n_vocab) {
+    switch (type) {
+      case SamplerType::kGreedy:
+        return llama_sampler_init_greedy();
+      case SamplerType::kTopK:
+        return llama_sampler_init_top_k(config.top_k);
+      case SamplerType::kTopP:
+        return llama_sampler_init_top_p(config.top_p, config.min_keep);
+      case SamplerType::kMinP:
+        return llama_sampler_init_min_p(config.min_p, config.min_keep);
+      case SamplerType::kTypical:
+        return llama_sampler_init_typical(config.typical_p, config.min_keep);
+      case SamplerType::kTemperature:
+        return llama_sampler_init_temp(config.temperature);
+      case SamplerType::kPenalties:
+        return llama_sampler_init_penalties(
+          config.penalty_last_n, config.penalty_repeat, config.penalty_freq,
+          config.penalty_present);
+      case SamplerType::kLogitBias:
+        if (n_vocab <= 0) {
+          return nullptr;
+        }
+        return llama_sampler_init_logit_bias(
+          n_vocab, static_cast<int32_t>(config.logit_biases.size()),
+          config.logit_biases.data());
+      case SamplerType::kMirostat:
+        if (n_vocab <= 0) {
+          return nullptr;
+        }
+        return llama_sampler_init_mirostat(n_vocab, config.seed,
+                                           config.mirostat_tau,
+                                           config.mirostat_eta,
+                                           config.mirostat_m);
+      case SamplerType::kMirostatV2:
+        return llama_sampler_init_mirostat_v2(config.seed, config.mirostat_tau,
+                                              config.mirostat_eta);
+      case SamplerType::kDist:
+        return llama_sampler_init_dist(config.seed);
+    }
+    return nullptr;
+  }
 
   std::unique_ptr<llama_sampler, decltype(&llama_sampler_free)> sampler_;
+  bool is_pure_greedy_ = false;  // argmaxの高速パスを使えるか
 };
 
 }  // namespace llama_cpp
@@ -0,0 +1,99 @@
+﻿// LlamaSamplerBenchmark.h
+#pragma once
+#include <Siv3D.hpp>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "LlamaSampler.h"
+
+namespace llama_cpp {
+
+// サンプラーチェーンの1トークンあたりのコストを計測するマイクロベンチマーク
+// モデルやコンテキストは不要で、合成したロジットに対してサンプラーを直接適用する
+// 起動引数 --bench sampler で実行される
+class LlamaSamplerBenchmark {
+  public:
+  // Qwen系モデルの語彙数
+  static constexpr int32_t kQwenVocabSize = 151936;
+
+  // 1つの設定について、1トークンあたりの平均サンプリング時間（マイクロ秒）を計測する
+  // llama_sampler_sample() と同じく、全語彙の候補配列を構築してからチェーンを適用する
+  static double Measure(const SamplingConfig& config, int32_t n_vocab = kQwenVocabSize,
+                        int32_t iterations = 200) {
+    auto sampler_result = LlamaSampler::Create(config);
+    if (!sampler_result) {
+      return -1.0;
+    }
+    const LlamaSampler& sampler = *sampler_result;
+
+    const std::vector<float> logits = CreateLogits(n_vocab);
+    std::vector<llama_token_data> candidates(static_cast<size_t>(n_vocab));
+    volatile llama_token sink = 0;  // 最適化で処理が消されないようにする
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int32_t it = 0; it < iterations; ++it) {
+      if (sampler.IsPureGreedy()) {
+        sink = LlamaSampler::ArgMax(logits.data(), n_vocab);
+        continue;
+      }
+
+      for (int32_t i = 0; i < n_vocab; ++i) {
+        candidates[i] = llama_token_data{i, logits[i], 0.0f};
+      }
+      llama_token_data_array cur_p = {candidates.data(), candidates.size(), -1, false};
+      llama_sampler_apply(sampler.GetRawSampler(), &cur_p);
+      sink = cur_p.data[cur_p.selected].id;
+      llama_sampler_accept(sampler.GetRawSampler(), sink);
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+  }
+
+  // 代表的なチェーンを計測してコンソールに出力する
+  static void RunAll(int32_t n_vocab = kQwenVocabSize, int32_t iterations = 200) {
+    s3d::Console << U"=== LlamaSampler ベンチマーク (n_vocab=" << n_vocab << U") ===";
+
+    SamplingConfig legacy;  // top_k → top_p → temp → dist
+    Report(U"top_k/top_p/temp/dist", Measure(legacy, n_vocab, iterations));
+
+    SamplingConfig greedy_chain;  // チェーン経由のgreedy（高速パスなしの比較用）
+    greedy_chain.chain = {SamplerType::kPenalties, SamplerType::kGreedy};
+    Report(U"penalties/greedy", Measure(greedy_chain, n_vocab, iterations));
+
+    SamplingConfig min_p;
+    min_p.chain = {SamplerType::kMinP, SamplerType::kTemperature, SamplerType::kDist};
+    Report(U"min_p/temp/dist", Measure(min_p, n_vocab, iterations));
+
+    SamplingConfig mirostat;
+    mirostat.chain = {SamplerType::kTemperature, SamplerType::kMirostatV2};
+    Report(U"temp/mirostat_v2", Measure(mirostat, n_vocab, iterations));
+
+    SamplingConfig greedy;  // argmaxの高速パス
+    greedy.chain = {SamplerType::kGreedy};
+    Report(U"greedy (fast path)", Measure(greedy, n_vocab, iterations));
+  }
+
+  private:
+  // 再現性のある合成ロジットを作成する
+  static std::vector<float> CreateLogits(int32_t n_vocab) {
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> dist(0.0f, 3.0f);
+    std::vector<float> logits(static_cast<size_t>(n_vocab));
+    for (float& logit : logits) {
+      logit = dist(rng);
+    }
+    return logits;
+  }
+
+  static void Report(s3d::StringView name, double micro_seconds) {
+    if (micro_seconds < 0.0) {
+      s3d::Console << name << U": サンプラーの作成に失敗しました";
+      return;
+    }
+    s3d::Console << name << U": " << micro_seconds << U" us/token";
+  }
+};
+
+}  // namespace llama_cpp
@@ -0,0 +1,230 @@
+﻿// LlamaScratchArena.h
+#pragma once
+#include <Siv3D.hpp>
+#include <string>
+#include <vector>
+
+#include "llama.h"
+
+namespace llama_cpp {
+
+// テキスト生成で使い回す作業領域
+// プロンプトのUTF-8バイト列、トークンID列、ピース文字列、生成テキストを保持し、
+// 一度確保した容量を次回以降の生成でも再利用する（定常状態ではトークン毎のヒープ確保なし）
+class LlamaScratchArena {
+  public:
+  // トークン数の初期見積もり（UTF-8バイト数に対する比率）
+  // 日本語主体のプロンプトでは1トークンあたり2～3バイト程度になる
+  static constexpr size_t kTokenEstimateDivisor = 2;
+  // ピースバッファの初期サイズ
+  static constexpr size_t kInitialPieceSize = 64;
+
+  LlamaScratchArena() = default;
+
+  // コピー禁止、ムーブ可能
+  LlamaScratchArena(const LlamaScratchArena&) = delete;
+  LlamaScratchArena& operator=(const LlamaScratchArena&) = delete;
+  LlamaScratchArena(LlamaScratchArena&&) = default;
+  LlamaScratchArena& operator=(LlamaScratchArena&&) = default;
+
+  // プロンプトをUTF-8に変換し、トークン化する
+  // 見積もり容量で一度だけトークン化を試み、不足した場合のみ必要数で再試行する
+  // 成功時はトークン数、失敗時は0以下を返す
+  int32_t Tokenize(const llama_vocab* vocab, s3d::StringView prompt) {
+    EncodeUTF8(prompt);
+
+    const size_t estimate = utf8_.size() / kTokenEstimateDivisor + 16;
+    ResizeTokens(estimate);
+
+    int32_t n_tokens = llama_tokenize(
+      vocab, utf8_.data(), static_cast<int32_t>(utf8_.size()), tokens_.data(),
+      static_cast<int32_t>(tokens_.size()), true, true);
+
+    if (n_tokens < 0) {
+      // 負の値は必要なトークン数を表す
+      ++tokenize_retry_count_;
+      ResizeTokens(static_cast<size_t>(-n_tokens));
+      n_tokens = llama_tokenize(
+        vocab, utf8_.data(), static_cast<int32_t>(utf8_.size()),
+        tokens_.data(), static_cast<int32_t>(tokens_.size()), true, true);
+    }
+
+    if (n_tokens <= 0) {
+      return n_tokens;
+    }
+
+    token_count_ = static_cast<size_t>(n_tokens);
+    return n_tokens;
+  }
+
+  // 生成開始前の準備（生成テキストのクリアと容量確保）
+  void BeginGeneration(int num_predict_tokens) {
+    generated_text_.clear();
+    pending_size_ = 0;
+
+    // 1トークンあたり最大数文字程度を想定して事前確保
+    const size_t required = static_cast<size_t>(num_predict_tokens) * 4;
+    const size_t text_capacity = generated_text_.capacity();
+    generated_text_.reserve(required);
+    CountGrowth(text_capacity, generated_text_.capacity());
+
+    const size_t piece_capacity = piece_.capacity();
+    if (piece_.size() < kInitialPieceSize) {
+      piece_.resize(kInitialPieceSize);
+    }
+    CountGrowth(piece_capacity, piece_.capacity());
+  }
+
+  // 生成終了時に呼ぶ
+  // 最後のトークンで途切れたマルチバイト文字は置換文字にして生成テキストへ追加する
+  // 追加された文字列のビュー（生成テキスト末尾）を返す（保留がなければ空）
+  s3d::StringView FinishGeneration() {
+    const size_t begin = generated_text_.size();
+    if (pending_size_ > 0) {
+      PushChar(U'\uFFFD');
+      pending_size_ = 0;
+    }
+    return s3d::StringView(generated_text_).substr(begin);
+  }
+
+  // トークンをピースに変換し、完成した文字を生成テキストへ追加する
+  // マルチバイト文字がトークン境界で分割された場合は次のトークンまで保留する
+  // 今回追加された文字列のビュー（生成テキスト末尾）を返す
+  s3d::StringView AppendToken(const llama_vocab* vocab, llama_token token) {
+    int32_t n = llama_token_to_piece(vocab, token, piece_.data(),
+                                     static_cast<int32_t>(piece_.size()), 0,
+                                     true);
+    if (n < 0) {
+      // 負の値は必要なバイト数を表す
+      const size_t piece_capacity = piece_.capacity();
+      piece_.resize(static_cast<size_t>(-n));
+      CountGrowth(piece_capacity, piece_.capacity());
+      n = llama_token_to_piece(vocab, token, piece_.data(),
+                               static_cast<int32_t>(piece_.size()), 0, true);
+    }
+
+    const size_t begin = generated_text_.size();
+    for (int32_t i = 0; i < n; ++i) {
+      PushByte(static_cast<uint8_t>(piece_[i]));
+    }
+
+    return s3d::StringView(generated_text_).substr(begin);
+  }
+
+  // トークン化結果
+  llama_token* GetTokens() { return tokens_.data(); }
+  size_t GetTokenCount() const { return token_count_; }
+
+  // これまでに生成されたテキスト
+  const s3d::String& GetGeneratedText() const { return generated_text_; }
+
+  // 作業領域のバッファが実際に確保し直された回数（容量が変わった回数）
+  // 作業領域以外の確保は含まないため、生成全体の確保回数はLlamaTextGeneratorの統計を見る
+  size_t GetGrowCount() const { return grow_count_; }
+
+  // トークン化の再試行回数
+  size_t GetTokenizeRetryCount() const { return tokenize_retry_count_; }
+
+  private:
+  // UTF-32文字列をUTF-8へ変換して utf8_ に格納する（容量は再利用）
+  void EncodeUTF8(s3d::StringView text) {
+    // UTF-8では1文字最大4バイト
+    const size_t required = text.size() * 4;
+    const size_t utf8_capacity = utf8_.capacity();
+    utf8_.reserve(required);
+    CountGrowth(utf8_capacity, utf8_.capacity());
+
+    utf8_.clear();
+    for (const char32 ch : text) {
+      if (ch < 0x80) {
+        utf8_.push_back(static_cast<char>(ch));
+      } else if (ch < 0x800) {
+        utf8_.push_back(static_cast<char>(0xC0 | (ch >> 6)));
+        utf8_.push_back(static_cast<char>(0x80 | (ch & 0x3F)));
+      } else if (ch < 0x10000) {
+        utf8_.push_back(static_cast<char>(0xE0 | (ch >> 12)));
+        utf8_.push_back(static_cast<char>(0x80 | ((ch >> 6) & 0x3F)));
+        utf8_.push_back(static_cast<char>(0x80 | (ch & 0x3F)));
+      } else {
+        utf8_.push_back(static_cast<char>(0xF0 | (ch >> 18)));
+        utf8_.push_back(static_cast<char>(0x80 | ((ch >> 12) & 0x3F)));
+        utf8_.push_back(static_cast<char>(0x80 | ((ch >> 6) & 0x3F)));
+        utf8_.push_back(static_cast<char>(0x80 | (ch & 0x3F)));
+      }
+    }
+  }
+
+  // トークン配列のサイズ変更（容量が足りない場合のみ確保が発生する）
+  void ResizeTokens(size_t size) {
+    const size_t capacity = tokens_.capacity();
+    tokens_.resize(size);
+    CountGrowth(capacity, tokens_.capacity());
+  }
+
+  // 生成テキストへ1文字追加する（容量超過による再確保も計上する）
+  void PushChar(char32 ch) {
+    const size_t capacity = generated_text_.capacity();
+    generated_text_.push_back(ch);
+    CountGrowth(capacity, generated_text_.capacity());
+  }
+
+  // 操作の前後で容量が変わっていれば、確保し直されたとして数える
+  void CountGrowth(size_t before, size_t after) {
+    if (after != before) {
+      ++grow_count_;
+    }
+  }
+
+  // UTF-8を1バイトずつデコードし、文字が完成したら生成テキストへ追加する
+  void PushByte(uint8_t byte) {
+    if (pending_size_ == 0) {
+      if (byte < 0x80) {
+        PushChar(static_cast<char32>(byte));
+        return;
+      }
+      pending_expected_ = (byte >= 0xF0) ? 4 : (byte >= 0xE0) ? 3 : (byte >= 0xC0) ? 2 : 0;
+      if (pending_expected_ == 0) {
+        // 先頭バイトとして不正
+        PushChar(U'\uFFFD');
+        return;
+      }
+      pending_[pending_size_++] = byte;
+      return;
+    }
+
+    if ((byte & 0xC0) != 0x80) {
+      // 継続バイトでない場合は保留中の文字を破棄してやり直す
+      PushChar(U'\uFFFD');
+      pending_size_ = 0;
+      PushByte(byte);
+      return;
+    }
+
+    pending_[pending_size_++] = byte;
+    if (pending_size_ < pending_expected_) {
+      return;
+    }
+
+    char32 ch = pending_[0] & (0xFF >> (pending_expected_ + 1));
+    for (size_t i = 1; i < pending_size_; ++i) {
+      ch = (ch << 6) | (pending_[i] & 0x3F);
+    }
+    PushChar(ch);
+    pending_size_ = 0;
+  }
+
+  std::string utf8_;                  // プロンプトのUTF-8バイト列
+  std::vector<llama_token> tokens_;   // トークンID列
+  size_t token_count_ = 0;            // 有効なトークン数
+  std::vector<char> piece_;           // トークン→ピース変換用バッファ
+  s3d::String generated_text_;        // 生成テキスト
+
+  uint8_t pending_[4] = {};           // デコード途中のUTF-8バイト
+  size_t pending_size_ = 0;           // 保留中のバイト数
+  size_t pending_expected_ = 0;       // 現在の文字に必要なバイト数
+
+  size_t grow_count_ = 0;             // 作業領域の再確保回数
+  size_t tokenize_retry_count_ = 0;   // トークン化の再試行回数
+};
+
+}  // namespace llama_cpp
@@ -18,6 +18,7 @@ class LlamaTextBuffer {
     s3d::String text;
     std::atomic<bool> is_complete{false};    // atomic化でmutex不要
     std::atomic<bool> is_generating{false};  // atomic化でmutex不要
+    std::atomic<size_t> version{0};          // textが更新されるたびに加算される
   };
 
   // shared_ptrで管理し、非同期処理中にオブジェクトが破棄されても安全にアクセス可能にする
@@ -47,38 +48,59 @@ class LlamaTextBuffer {
     generator.WaitAllTasks();
 
     // バッファを初期化
+    // 生成側の作業領域（LlamaScratchArena）と同じ見積もりで容量を確保し、トークンごとの再確保を避ける
+    // clear()は容量を保持するため、2回目以降の生成では確保は起きない
     {
       std::lock_guard<std::mutex> lock(buffer_data_->text_mutex);
       buffer_data_->text.clear();
+      buffer_data_->text.reserve(static_cast<size_t>(request.num_predict_tokens) * 4);
     }
+    ++buffer_data_->version;
     buffer_data_->is_complete = false;
     buffer_data_->is_generating = true;
 
     // 非同期生成を開始（キャプチャでbuffer_data_を共有）
     generator.GenerateAsync(
       request, [buffer_data = buffer_data_](const TakeCallBackInfo& info) {
+        // is_endは生成完了を示すフラグ
+        // info内の文字列はコールバック内でのみ有効なため、ここでコピーする
+        // 終了時は途切れていた文字の確定分も含む生成テキスト全体で置き換える（容量は再利用される）
         {
           std::lock_guard<std::mutex> lock(buffer_data->text_mutex);
-          buffer_data->text += info.token;
+          if (info.is_end) {
+            buffer_data->text.assign(info.generated_text);
+          } else {
+            buffer_data->text.append(info.token);
+          }
         }
-        // is_endは生成完了を示すフラグ
+        ++buffer_data->version;
         if (info.is_end) {
-          {
-            std::lock_guard<std::mutex> lock(buffer_data->text_mutex);
-            buffer_data->text = info.generated_text;
-          }
           buffer_data->is_complete = true;
           buffer_data->is_generating = false;
         }
       });
   }
 
+  // 生成を行わずに完成済みのテキストを設定する（リプレイ用）
+  // 完了扱いになるため、呼び出し側はStartGeneration()のときと同じ流れで結果を受け取れる
+  // 記録されたテキストは終了時に確定した文字まで含むため、生成した場合と同じ内容になる
+  void CompleteWith(const s3d::String& text) {
+    {
+      std::lock_guard<std::mutex> lock(buffer_data_->text_mutex);
+      buffer_data_->text.assign(text);
+    }
+    ++buffer_data_->version;
+    buffer_data_->is_generating = false;
+    buffer_data_->is_complete = true;
+  }
+
   // バッファをクリア
   void ClearBuffer() {
     {
       std::lock_guard<std::mutex> lock(buffer_data_->text_mutex);
       buffer_data_->text.clear();
     }
+    ++buffer_data_->version;
     buffer_data_->is_complete = false;
     buffer_data_->is_generating = false;
   }
@@ -88,6 +110,10 @@ class LlamaTextBuffer {
 
   // テキスト生成中かどうかを確認
   bool IsGenerating() const { return buffer_data_->is_generating.load(); }
+
+  // テキストの更新回数を取得
+  // 前回取得時と値が変わっていなければGetText()でコピーする必要はない
+  size_t GetVersion() const { return buffer_data_->version.load(); }
 };
 
 }  // namespace llama_cpp
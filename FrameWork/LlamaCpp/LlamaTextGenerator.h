@@ -15,9 +15,14 @@
 #include "ChatMLUtil.h"
 #include "LlamaComponents.h"
 #include "LlamaContext.h"
+#include "LlamaContextPool.h"
 #include "LlamaModel.h"
 #include "LlamaModelManager.h"
+#include "LlamaPrefetchScheduler.h"
 #include "LlamaSampler.h"
+#include "LlamaScratchArena.h"
+#include "Util/AllocationCounter.h"
+#include "Util/FrameProfiler.h"
 
 namespace llama_cpp {
 
@@ -28,10 +33,25 @@ struct GenerationResult {
   s3d::String error_message;
 };
 
+// トークンごとのコールバック情報
+// 文字列はジェネレータの作業領域を指すビューのため、コールバック内でのみ有効
 struct TakeCallBackInfo {
-  s3d::String token;           // 生成されたトークン
-  s3d::String generated_text;  // これまでに生成されたテキスト
-  bool is_end = false;         // 生成終了を示すフラグ
+  s3d::StringView token;           // 生成されたトークン
+  s3d::StringView generated_text;  // これまでに生成されたテキスト
+  bool is_end = false;             // 生成終了を示すフラグ
+};
+
+// 生成処理の統計情報
+struct GenerationStats {
+  size_t generation_count = 0;           // 生成回数
+  size_t prompt_token_count = 0;         // 直近のプロンプトトークン数
+  size_t generated_token_count = 0;      // 直近の生成トークン数
+  size_t arena_grow_count = 0;           // 作業領域の再確保回数（累計）
+  size_t last_arena_grow_count = 0;      // 直近の生成での作業領域の再確保回数
+  uint64 last_alloc_count = 0;           // 直近の生成で生成スレッドが行ったヒープ確保回数
+                                         // （ENABLE_ALLOCATION_COUNTER定義時のみ。llama.cpp内部の確保は含まない）
+  size_t tokenize_retry_count = 0;       // トークン化の再試行回数（累計）
+  size_t reused_token_count = 0;         // 直近の生成でKVキャッシュから再利用したトークン数
 };
 
 using TokenCallBack = std::function<void(const TakeCallBackInfo&)>;
@@ -39,11 +59,21 @@ using TokenCallBack = std::function<void(const TakeCallBackInfo&)>;
 // 非同期テキスト生成クラス
 class LlamaTextGenerator {
   public:
+  // プリフィル時に一度にデコードするトークン数
+  // 小さいほど対話的な生成が来たときに早く中断できる
+  static constexpr int32_t kPrefillChunkSize = 32;
+
   LlamaTextGenerator() = default;
 
   ~LlamaTextGenerator() {
     CancelAllTasks();
     WaitAllTasks();
+
+    // コンテキストは破棄せずプールへ返却し、次回の初期化で再利用する
+    if (context_) {
+      LlamaContextPool::GetInstance().Release(model_, context_config_,
+                                              std::move(context_));
+    }
   }
 
   // コピー禁止、ムーブ可能
@@ -61,24 +91,37 @@ class LlamaTextGenerator {
       return InitResult::Error(U"無効なモデルが指定されました");
     }
 
-    // コンテキストの作成
-    auto context_result = LlamaContext::Create(*model, context_config);
-    if (!context_result) {
+    // コンテキストの取得（プールに空きがあれば再利用、なければ新規作成）
+    auto context = LlamaContextPool::GetInstance().Acquire(model, context_config);
+    if (!context) {
       return InitResult::Error(U"コンテキストの作成に失敗しました");
     }
 
     // サンプラーの作成
-    auto sampler_result = LlamaSampler::Create(sampling_config);
+    auto sampler_result = LlamaSampler::Create(sampling_config, model->GetVocab());
     if (!sampler_result) {
+      LlamaContextPool::GetInstance().Release(model, context_config,
+                                              std::move(context));
       return InitResult::Error(U"サンプラーの作成に失敗しました");
     }
 
+    // 再初期化の場合は以前のコンテキストをプールへ返却
+    if (context_) {
+      LlamaContextPool::GetInstance().Release(model_, context_config_,
+                                              std::move(context_));
+    }
+
     // 成功時にコンポーネントを設定
     model_ = model;  // 共有ポインタをそのまま使用
-    context_ = std::make_unique<LlamaContext>(std::move(*context_result));
+    context_ = std::move(context);
+    context_config_ = context_config;
     sampler_ = std::make_unique<LlamaSampler>(std::move(*sampler_result));
     system_prompt_ = system_prompt;  // システムプロンプトを保存
 
+    // プールから取得したコンテキストはメモリがクリア済み
+    cached_tokens_.clear();
+    cached_tokens_.reserve(llama_n_ctx(context_->GetRawContext()));
+
     is_initialized_ = true;
 #ifdef _DEBUG
     s3d::Console << U"LlamaTextGenerator: 初期化が完了しました";
@@ -94,9 +137,14 @@ class LlamaTextGenerator {
       return {false, U"", U"初期化されていません"};
     }
 
-    chat_history_.emplace_back(ChatRole::User, request.prompt);
+    {
+      std::lock_guard<std::mutex> lock(chat_history_mutex_);
+      chat_history_.emplace_back(ChatRole::User, request.prompt);
+    }
 
     {
+      // 先読み処理に中断を促してから生成を行う
+      LlamaPrefetchScheduler::InteractiveScope interactive_scope;
       std::lock_guard<std::mutex> lock(generation_mutex_);
 
       auto result = RunGeneration(request, nullptr);
@@ -115,15 +163,29 @@ class LlamaTextGenerator {
       return;
     }
 
-    chat_history_.emplace_back(ChatRole::User, request.prompt);
+    {
+      std::lock_guard<std::mutex> lock(chat_history_mutex_);
+      chat_history_.emplace_back(ChatRole::User, request.prompt);
+    }
+
+    // 先読み処理にはリクエストの時点で中断を促す
+    // タスクのスレッドが動き出すまでの間に先読みタスクが始まらないよう、スコープはここで作ってタスクへ渡す
+    auto interactive_scope = std::make_shared<LlamaPrefetchScheduler::InteractiveScope>();
 
     {
       std::lock_guard<std::mutex> lock(tasks_mutex_);
       // 新しい非同期タスクを開始
       active_tasks_.emplace_back(
-        std::async(std::launch::async, [this, request, on_token_callback]() {
-          std::lock_guard<std::mutex> generation_lock(generation_mutex_);
-          RunGeneration(request, on_token_callback);
+        std::async(std::launch::async, [this, request, on_token_callback,
+                                        interactive_scope = std::move(interactive_scope)]() mutable {
+          // std::asyncのスレッドはプールから再利用されることがあるため、毎回名前を付け直す
+          FrameProfiler::SetThreadName("llm_generate");
+          {
+            std::lock_guard<std::mutex> generation_lock(generation_mutex_);
+            RunGeneration(request, on_token_callback);
+          }
+          // ラムダはfutureが破棄されるまで残ることがあるため、生成が終わった時点で明示的に終了を通知する
+          interactive_scope.reset();
         }));
     }
   }
@@ -168,6 +230,7 @@ class LlamaTextGenerator {
       // コンテキストのメモリをクリア（会話履歴をリセット）
       llama_memory_t memory = llama_get_memory(context_->GetRawContext());
       llama_memory_clear(memory, true);  // dataも含めてクリア
+      cached_tokens_.clear();
     }
 
 #ifdef _DEBUG
@@ -189,55 +252,91 @@ class LlamaTextGenerator {
   // 初期化状態の確認
   bool IsInitialized() const { return is_initialized_; }
 
-  private:
-  // 内部的なテキスト生成処理
-  GenerationResult RunGeneration(const LlmRequest& request, TokenCallBack on_token_callback) {
-    // システムプロンプトがある場合はChatML形式でプロンプトを構築
+  // システムプロンプトとこれまでの会話履歴を事前にKVキャッシュへ載せておく
+  // 次回の生成では共通部分のデコードが省略され、新しいユーザー発言のみを処理すればよくなる
+  // should_yieldがtrueを返した場合はチャンクの切れ目で中断してfalseを返す
+  // 生成中で処理できなかった場合もfalseを返す（呼び出し側で再試行する想定）
+  bool Prefill(const std::function<bool()>& should_yield) {
+    if (!IsInitialized()) {
+      return true;
+    }
 
-    s3d::String final_prompt;
-    // ChatMLUtilを用いてsystem_prompt_とchat_history_を組み合わせた文字列を作成
-    {
-      std::lock_guard<std::mutex> lock(chat_history_mutex_);
+    // 生成中であれば後で再試行する
+    std::unique_lock<std::mutex> lock(generation_mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+      return false;
+    }
 
-      // chat_history_をs3d::Arrayに変換
-      s3d::Array<ChatMessage> conversation;
-      for (const auto& message : chat_history_) {
-        conversation.emplace_back(message.role, message.content);
+    const s3d::String prompt = BuildPrompt(false);
+    const int n_prompt = scratch_arena_.Tokenize(model_->GetVocab(), prompt);
+    if (n_prompt <= 0) {
+      return true;
+    }
+
+    llama_token* tokens = scratch_arena_.GetTokens();
+    size_t n_done = ReuseCachedPrefix(tokens, static_cast<size_t>(n_prompt), false);
+
+    // チャンクごとにデコードし、対話的な生成が来たら中断する
+    while (n_done < static_cast<size_t>(n_prompt)) {
+      if (should_yield && should_yield()) {
+        return false;
       }
 
-      // ChatML形式でプロンプトを構築
-      final_prompt = ChatMLUtil::CreateConversationChatML(system_prompt_, conversation);
+      const int32_t n_chunk = std::min<int32_t>(kPrefillChunkSize, n_prompt - static_cast<int32_t>(n_done));
+      llama_batch batch = llama_batch_get_one(tokens + n_done, n_chunk);
+      if (llama_decode(context_->GetRawContext(), batch)) {
+        // 失敗時はキャッシュ状態が不明になるためクリアしておく
+        llama_memory_clear(llama_get_memory(context_->GetRawContext()), true);
+        cached_tokens_.clear();
+        return true;
+      }
 
-      // アシスタントの開始部分を追加（生成開始のため）
-      final_prompt += U"\n<|im_start|>assistant\n";
+      cached_tokens_.insert(cached_tokens_.end(), tokens + n_done, tokens + n_done + n_chunk);
+      n_done += n_chunk;
     }
 
-    // プロンプトのトークン化
-    const std::string prompt_utf8 = final_prompt.toUTF8();
-    int n_prompt = -llama_tokenize(model_->GetVocab(), prompt_utf8.c_str(),
-                                   static_cast<int32_t>(prompt_utf8.size()),
-                                   nullptr, 0, true, true);
+#ifdef _DEBUG
+    s3d::Console << U"LlamaTextGenerator: プリフィル完了 (" << n_prompt << U"トークン)";
+#endif
+    return true;
+  }
+
+  // 生成処理の統計情報を取得
+  GenerationStats GetStats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+  }
+
+  private:
+  // 内部的なテキスト生成処理
+  GenerationResult RunGeneration(const LlmRequest& request, TokenCallBack on_token_callback) {
+    const FrameProfiler::Scope scope{"LlamaTextGenerator::RunGeneration"};
+
+    // システムプロンプトと会話履歴からChatML形式でプロンプトを構築
+    const s3d::String final_prompt = BuildPrompt(true);
+
+    // プロンプトのトークン化（作業領域を再利用し、1回で済まなければ再試行）
+    const size_t grow_count_before = scratch_arena_.GetGrowCount();
+    const auto alloc_before = AllocationCounter::GetThreadSnapshot();
+    const int n_prompt = scratch_arena_.Tokenize(model_->GetVocab(), final_prompt);
 
     if (n_prompt <= 0) {
       return {false, U"", U"トークン化に失敗しました"};
     }
 
-    std::vector<llama_token> prompt_tokens(n_prompt);
-    if (llama_tokenize(model_->GetVocab(), prompt_utf8.c_str(),
-                       static_cast<int32_t>(prompt_utf8.size()),
-                       prompt_tokens.data(), n_prompt, true, true) < 0) {
-      return {false, U"", U"トークン化処理でエラーが発生しました"};
-    }
+    // KVキャッシュに残っている共通部分（システムプロンプトなど）はデコードを省略する
+    llama_token* prompt_tokens = scratch_arena_.GetTokens();
+    const size_t n_reuse = ReuseCachedPrefix(prompt_tokens, static_cast<size_t>(n_prompt), true);
 
-    llama_batch batch = llama_batch_get_one(
-      prompt_tokens.data(), static_cast<int32_t>(prompt_tokens.size()));
+    llama_batch batch = llama_batch_get_one(prompt_tokens + n_reuse, n_prompt - static_cast<int32_t>(n_reuse));
 
-
-    std::string generated_text;
-    String token_text;
+    scratch_arena_.BeginGeneration(request.num_predict_tokens);
+    sampler_->Reset();
+    size_t generated_token_count = 0;
 
     // テキスト生成ループ
-    for (int n_pos = 0; n_pos + batch.n_tokens < n_prompt + request.num_predict_tokens;) {
+    // ループ内ではヒープ確保を行わない（作業領域の容量を再利用する）
+    for (int n_pos = static_cast<int>(n_reuse); n_pos + batch.n_tokens < n_prompt + request.num_predict_tokens;) {
       // キャンセル確認
       if (cancel_flag_.load()) {
 #ifdef _DEBUG
@@ -249,50 +348,51 @@ class LlamaTextGenerator {
 
       // 推論実行
       if (llama_decode(context_->GetRawContext(), batch)) {
+        // 失敗時はキャッシュ状態が不明になるためクリアしておく
+        llama_memory_clear(llama_get_memory(context_->GetRawContext()), true);
+        cached_tokens_.clear();
         return {false, U"", U"推論処理に失敗しました"};
       }
 
+      // KVキャッシュに載ったトークンを記録（容量はn_ctx分確保済み）
+      cached_tokens_.insert(cached_tokens_.end(), batch.token, batch.token + batch.n_tokens);
       n_pos += batch.n_tokens;
 
-      // 次のトークンをサンプリング
-      llama_token new_token_id = llama_sampler_sample(
-        sampler_->GetRawSampler(), context_->GetRawContext(), -1);
+      // 次のトークンをサンプリング（greedy設定ならargmaxの高速パス）
+      llama_token new_token_id = sampler_->Sample(context_->GetRawContext());
 
       // 終了トークンチェック
       if (llama_vocab_is_eog(model_->GetVocab(), new_token_id)) {
         break;
       }
 
-      // トークンをテキストに変換
-      char buffer[1024];
-      int n = llama_token_to_piece(model_->GetVocab(), new_token_id, buffer,
-                                   sizeof(buffer), 0, true);
-
-      if (n > 0) {
-        generated_text.append(buffer, n);
-        token_text += s3d::Unicode::FromUTF8(std::string(buffer, n));
-
-        // コールバック実行
-        if (on_token_callback && !token_text.empty()) {
-          TakeCallBackInfo info;
-          info.token = token_text;
-          info.generated_text = s3d::Unicode::FromUTF8(generated_text);
-          info.is_end = false;
-          on_token_callback(info);
-
-          token_text.clear();
-        }
+      ++generated_token_count;
+
+      // トークンをテキストに変換（分割されたマルチバイト文字は次のトークンで完成する）
+      const s3d::StringView token_text = scratch_arena_.AppendToken(model_->GetVocab(), new_token_id);
+
+      // コールバック実行
+      if (on_token_callback && !token_text.empty()) {
+        TakeCallBackInfo info;
+        info.token = token_text;
+        info.generated_text = scratch_arena_.GetGeneratedText();
+        info.is_end = false;
+        on_token_callback(info);
       }
 
       // 次のバッチを準備
       batch = llama_batch_get_one(&new_token_id, 1);
     }
 
+    // 最後のトークンで途切れたマルチバイト文字を確定させる（終了コールバックのtokenで渡す）
+    const s3d::StringView tail_text = scratch_arena_.FinishGeneration();
+    const s3d::String& generated_text = scratch_arena_.GetGeneratedText();
+
     // 終了コールバック実行
     if (on_token_callback) {
       TakeCallBackInfo info;
-      info.token = U"";
-      info.generated_text = s3d::Unicode::FromUTF8(generated_text);
+      info.token = tail_text;
+      info.generated_text = generated_text;
       info.is_end = true;
       on_token_callback(info);
     }
@@ -300,21 +400,82 @@ class LlamaTextGenerator {
     // 生成されたテキストをチャット履歴に追加
     {
       std::lock_guard<std::mutex> lock(chat_history_mutex_);
-      chat_history_.emplace_back(ChatRole::Assistant, s3d::Unicode::FromUTF8(generated_text));
+      chat_history_.emplace_back(ChatRole::Assistant, generated_text);
+    }
+
+    // 統計情報を更新
+    {
+      std::lock_guard<std::mutex> lock(stats_mutex_);
+      ++stats_.generation_count;
+      stats_.prompt_token_count = static_cast<size_t>(n_prompt);
+      stats_.generated_token_count = generated_token_count;
+      stats_.arena_grow_count = scratch_arena_.GetGrowCount();
+      stats_.last_arena_grow_count = scratch_arena_.GetGrowCount() - grow_count_before;
+      stats_.last_alloc_count = (AllocationCounter::GetThreadSnapshot() - alloc_before).count;
+      stats_.tokenize_retry_count = scratch_arena_.GetTokenizeRetryCount();
+      stats_.reused_token_count = n_reuse;
     }
 
     // パフォーマンス統計出力
     llama_perf_sampler_print(sampler_->GetRawSampler());
     llama_perf_context_print(context_->GetRawContext());
 
-    GenerationResult result = {true, s3d::Unicode::FromUTF8(generated_text), U""};
+    GenerationResult result = {true, generated_text, U""};
     return result;
   }
 
+  // システムプロンプトとチャット履歴からChatML形式のプロンプトを構築する
+  // add_assistant_startがtrueの場合はアシスタントの開始部分を末尾に追加する
+  s3d::String BuildPrompt(bool add_assistant_start) const {
+    s3d::String prompt;
+    {
+      std::lock_guard<std::mutex> lock(chat_history_mutex_);
+
+      // chat_history_をs3d::Arrayに変換
+      s3d::Array<ChatMessage> conversation;
+      for (const auto& message : chat_history_) {
+        conversation.emplace_back(message.role, message.content);
+      }
+
+      // ChatML形式でプロンプトを構築
+      prompt = ChatMLUtil::CreateConversationChatML(system_prompt_, conversation);
+    }
+
+    if (add_assistant_start) {
+      // アシスタントの開始部分を追加（生成開始のため）
+      prompt += U"\n<|im_start|>assistant\n";
+    }
+    return prompt;
+  }
+
+  // KVキャッシュ上のトークン列と新しいプロンプトの共通接頭辞を再利用する
+  // 共通部分より後ろのキャッシュを削除し、再利用できたトークン数を返す
+  // need_logitsがtrueの場合は最後のトークンのロジットを得るため、少なくとも1トークンは残す
+  size_t ReuseCachedPrefix(const llama_token* tokens, size_t n_tokens, bool need_logits) {
+    size_t n_common = 0;
+    while (n_common < cached_tokens_.size() && n_common < n_tokens &&
+           cached_tokens_[n_common] == tokens[n_common]) {
+      ++n_common;
+    }
+    if (need_logits && n_common >= n_tokens) {
+      n_common = n_tokens - 1;
+    }
+
+    llama_memory_t memory = llama_get_memory(context_->GetRawContext());
+    if (!llama_memory_seq_rm(memory, 0, static_cast<llama_pos>(n_common), -1)) {
+      // 部分削除に対応していないメモリの場合は全消去して先頭から処理する
+      llama_memory_clear(memory, true);
+      n_common = 0;
+    }
+    cached_tokens_.resize(n_common);
+    return n_common;
+  }
+
   // コンポーネント（モデルは共有ポインタで管理）
   std::shared_ptr<LlamaModel> model_;
   std::unique_ptr<LlamaContext> context_;
   std::unique_ptr<LlamaSampler> sampler_;
+  ContextConfig context_config_;  // プール返却時のキー
 
   // システムプロンプト（初期化時に設定）
   s3d::String system_prompt_;
@@ -330,6 +491,16 @@ class LlamaTextGenerator {
 
   // 同期処理用ミューテックス（同時実行を防ぐ）
   mutable std::mutex generation_mutex_;
+
+  // 生成処理の作業領域（generation_mutex_で保護される）
+  LlamaScratchArena scratch_arena_;
+
+  // KVキャッシュに載っているトークン列（generation_mutex_で保護される）
+  std::vector<llama_token> cached_tokens_;
+
+  // 統計情報
+  mutable std::mutex stats_mutex_;
+  GenerationStats stats_;
 };
 
 }  // namespace llama_cpp
@@ -103,9 +103,7 @@ class LlmScoreCalculator {
 
     // サンプリング設定（最速化）
     llama_cpp::SamplingConfig sampling_config;
-    sampling_config.temperature = 0.1f;  // 数値出力なので確定的に（0.8→0.1）
-    sampling_config.top_k = 5;           // 最小限に削減（20→5）
-    sampling_config.top_p = 0.5f;        // 大幅削減（0.8→0.5）
+    sampling_config.chain = {llama_cpp::SamplerType::kGreedy};  // 数値出力なので確定的に（temperature 0.1 → greedy）
 
     // システムプロンプト（点数のみ）
     s3d::String system_prompt = U"0-100の数字のみ答えるAI";
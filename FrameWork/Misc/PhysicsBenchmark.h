@@ -0,0 +1,93 @@
+﻿// PhysicsBenchmark.h
+#pragma once
+#include <Siv3D.hpp>
+#include <chrono>
+
+#include "EntityFactory.h"
+#include "SingletonCD/PxDataSingletonCD.h"
+#include "flecs/flecs.h"
+
+// PhysXの同期実行と非同期実行（simulate/fetchの分割）を比較するベンチマーク
+// DynamicSphereを大量に生成し、メインスレッドがPhysXの完了待ちで止まっている時間を計測する
+// Run(world)のworldはPxDataSingletonCDとEntityFactoryが初期化済みである必要がある
+// 起動引数 --bench physics では、RunInNewWorld()が専用のworldを用意して実行する
+class PhysicsBenchmark {
+  public:
+  PhysicsBenchmark() = delete;
+
+  // count: 生成する球の数, frames: 計測フレーム数
+  // frame_work_ms: 1フレームあたりの描画・ゲームロジックを模した処理時間
+  static void Run(flecs::world& world, int32 count = 10000, int32 frames = 300,
+                  double frame_work_ms = 8.0) {
+    assert(world.has<PxDataSingletonCD>());
+    PxDataSingletonCD& px = *world.get_ref<PxDataSingletonCD>().get();
+
+    // 球を格子状に積み上げる（近い球同士が同じAggregateに入るよう格子順に並べる）
+    Array<EntityFactory::SpawnTransform> transforms;
+    transforms.reserve(count);
+    const int32 side = static_cast<int32>(Math::Ceil(Math::Sqrt(count / 10.0)));
+    for (int32 i = 0; i < count; ++i) {
+      const Vec3 pos{(i % side) - side / 2.0, 1.0 + (i / (side * side)),
+                     ((i / side) % side) - side / 2.0};
+      transforms.push_back({pos});
+    }
+    Array<flecs::entity> spheres =
+      EntityFactory::DynamicSpheres(world, transforms, 0.4f);
+
+    Console << U"=== PhysicsBenchmark (" << count << U" spheres, " << frames
+            << U" frames) ===";
+
+    // 同期: simulate直後にfetchResults(true)で待つ
+    const double sync_stall_ms = Measure(frames, frame_work_ms, [&px]() {
+      px.Step();
+    });
+    Console << U"sync : 待ち時間 " << sync_stall_ms << U" ms/frame";
+
+    // 非同期: 前フレームで開始したステップを受け取り、次のステップを開始して戻る
+    const double async_stall_ms = Measure(frames, frame_work_ms, [&px]() {
+      px.FetchSimulation();
+      px.KickSimulation();
+    });
+    px.FetchSimulation();
+    Console << U"async: 待ち時間 " << async_stall_ms << U" ms/frame";
+
+    for (auto& sphere : spheres) {
+      sphere.destruct();
+    }
+  }
+
+  // PhysXとEntityFactoryを初期化した専用のworldを作ってRun()を実行する
+  // EntityFactoryのプレハブはこのworldに作られるため、ゲームのworldと同じプロセスでは使わないこと
+  // 残ったActorはworldの破棄時にシーンごと解放される
+  static void RunInNewWorld() {
+    flecs::world world;
+    world.add<PxDataSingletonCD>();
+    if (!world.get_ref<PxDataSingletonCD>()->InitializePx()) {
+      Console << U"PhysicsBenchmark: PhysXの初期化に失敗しました";
+      return;
+    }
+    EntityFactory::Initialize(world);
+    Run(world);
+  }
+
+  private:
+  // physics_tickの所要時間（メインスレッドが止まっている時間）の平均を返す
+  template <typename Func>
+  static double Measure(int32 frames, double frame_work_ms, Func physics_tick) {
+    using clock = std::chrono::steady_clock;
+    double total_ms = 0.0;
+    for (int32 frame = 0; frame < frames; ++frame) {
+      const auto start = clock::now();
+      physics_tick();
+      total_ms +=
+        std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+      // 描画・ゲームロジックの代わりにビジーループで時間を消費する
+      const auto work_end =
+        clock::now() + std::chrono::duration<double, std::milli>(frame_work_ms);
+      while (clock::now() < work_end) {
+      }
+    }
+    return total_ms / frames;
+  }
+};
@@ -0,0 +1,103 @@
+﻿// SpriteAnimationBenchmark.h
+#pragma once
+#include <Siv3D.hpp>
+#include <chrono>
+#include <thread>
+
+#include "CD/AtlasFrameArrayCD.h"
+#include "CD/FrameCD.h"
+#include "CD/SpriteAnimationCD.h"
+#include "CD/SpriteRegionCD.h"
+#include "CD/TimerCD.h"
+#include "System/SpriteAnimationSystem.h"
+#include "System/TimerSystem.h"
+#include "Util/EcsThreadUtil.h"
+#include "flecs/flecs.h"
+
+// 大量のアニメーションスプライトを更新するときの、flecsのワーカースレッド数によるスケーリングを計測するベンチマーク
+// 描画は行わず、TimerSystem（multi_threaded）とSpriteAnimationSystemだけを専用のworldで実行する
+// SpriteAnimationSystemはタイマーホイールで切り替わる分だけをメインスレッドで処理するため、
+// エンティティごとに毎フレーム走り、スレッド数で分割されるのはTimerSystemだけになる
+// （スレッド数によるスケーリングは実質TimerSystemのもの。切り替え間隔を長くするほど1フレームのコストが下がる）
+// 起動引数 --bench sprite で実行される
+class SpriteAnimationBenchmark {
+  public:
+  SpriteAnimationBenchmark() = delete;
+
+  // count: スプライトの数, frames: スレッド数ごとの計測フレーム数
+  // max_threads: 計測する最大スレッド数（0以下なら論理コア数）
+  // interval: アニメーションのフレーム切り替え間隔（秒）
+  static void Run(int32 count = 100000, int32 frames = 200,
+                  int32 max_threads = 0, double interval = 0.1) {
+    if (max_threads <= 0) {
+      max_threads =
+        Max(1, static_cast<int32>(std::thread::hardware_concurrency()));
+    }
+
+    flecs::world world;
+    TimerSystem::Register(world);
+    SpriteAnimationSystem::Register(world);
+
+    // 8フレームのアニメーションを同じアトラスの別領域として持たせる
+    const Texture atlas;
+    AtlasFrameArrayCD frames_cd;
+    for (int32 i = 0; i < 8; ++i) {
+      frames_cd.frames.push_back({atlas, Rect{i * 32, 0, 32, 32}});
+    }
+
+    world.defer_begin();
+    for (int32 i = 0; i < count; ++i) {
+      // 開始フレームをずらしておく（TimerCDはTimerSystemの負荷として持たせる）
+      world.entity()
+        .set<FrameCD>(FrameCD(i % 8))
+        .set<AtlasFrameArrayCD>(frames_cd)
+        .set<SpriteRegionCD>({atlas, frames_cd.frames[i % 8].region})
+        .set<SpriteAnimationCD>(SpriteAnimationCD(interval, true))
+        .set<TimerCD>(TimerCD(0.0));
+    }
+    world.defer_end();
+
+    Console << U"=== SpriteAnimationBenchmark (" << count << U" sprites, "
+            << frames << U" frames, interval " << interval << U" s) ===";
+
+    double single_ms = 0.0;
+    for (const int32 threads : ThreadCounts(max_threads)) {
+      EcsThreadUtil::EnableMultiThreading(world, threads);
+      const double ms = Measure(world, frames);
+      if (threads == 1) {
+        single_ms = ms;
+      }
+      Console << threads << U" threads: " << ms << U" ms/frame (x"
+              << (single_ms / ms) << U")";
+    }
+  }
+
+  private:
+  // 計測するスレッド数（1から2倍ずつ増やし、最後にmax_threadsちょうども計測する）
+  static Array<int32> ThreadCounts(int32 max_threads) {
+    Array<int32> counts;
+    for (int32 threads = 1; threads <= max_threads; threads *= 2) {
+      counts << threads;
+    }
+    if (counts.back() != max_threads) {
+      counts << max_threads;
+    }
+    return counts;
+  }
+
+  // world.progress()1回あたりの平均時間を返す
+  static double Measure(flecs::world& world, int32 frames) {
+    using clock = std::chrono::steady_clock;
+    // スレッドの起動直後の揺らぎを除くため、数フレーム空回しする
+    for (int32 i = 0; i < 10; ++i) {
+      world.progress(1.0f / 60.0f);
+    }
+    const auto start = clock::now();
+    for (int32 i = 0; i < frames; ++i) {
+      world.progress(1.0f / 60.0f);
+    }
+    return std::chrono::duration<double, std::milli>(clock::now() - start)
+             .count() /
+           frames;
+  }
+};
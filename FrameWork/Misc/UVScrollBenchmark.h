@@ -0,0 +1,63 @@
+﻿// UVScrollBenchmark.h
+#pragma once
+#include <Siv3D.hpp>
+#include <chrono>
+
+#include "Util/UVScrollMaterial.h"
+
+// テクスチャのスクロールを、メッシュの作り直しと定数バッファの更新で比較するマイクロベンチマーク
+//   rebuild: 毎フレームMeshData::Gridを作り直してDynamicMesh::fillで転送する（従来のWorkPhase）
+//   uniform: UVオフセットだけを定数バッファに書き込んでバインドする（UVScrollMaterial）
+// 1フレームあたりのCPU時間と、GPUへ送るバイト数を出力する（描画は行わない）
+// 起動引数 --bench uvscroll で実行される
+class UVScrollBenchmark {
+  public:
+  UVScrollBenchmark() = delete;
+
+  // size/resolution: ベルトのメッシュの大きさと分割数, frames: 計測フレーム数
+  static void Run(const Vec2& size = Vec2{800.0, 180.0}, int32 resolution = 1,
+                  int32 frames = 1000) {
+    const Float2 uv_scale{static_cast<float>(size.x / size.y), 1.0f};
+
+    Console << U"=== UVScrollBenchmark (" << resolution << U"x" << resolution
+            << U" grid, " << frames << U" frames) ===";
+
+    // 従来: メッシュデータを作り直して頂点とインデックスを丸ごと転送する
+    DynamicMesh mesh{MeshData::Grid(size, resolution, resolution, uv_scale)};
+    size_t rebuild_bytes = 0;
+    const double rebuild_us = Measure(frames, [&](int32 frame) {
+      const MeshData md =
+        MeshData::Grid(size, resolution, resolution, uv_scale,
+                       Float2{frame * 0.01f, 0.0f});
+      mesh.fill(md);
+      rebuild_bytes = md.vertices.size_bytes() + md.indices.size_bytes();
+    });
+    Report(U"rebuild", rebuild_us, rebuild_bytes);
+
+    // 変更後: 定数バッファのオフセットだけを書き換えてバインドする
+    ConstantBuffer<UVScrollCB> cb;
+    const double uniform_us = Measure(frames, [&](int32 frame) {
+      cb->offset = Float2{frame * 0.01f, 0.0f};
+      Graphics3D::SetVSConstantBuffer(4, cb);
+    });
+    Report(U"uniform", uniform_us, sizeof(UVScrollCB));
+  }
+
+  private:
+  // 1フレーム分の処理の平均時間（マイクロ秒）を返す
+  template <typename Func>
+  static double Measure(int32 frames, Func per_frame) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int32 frame = 0; frame < frames; ++frame) {
+      per_frame(frame);
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() /
+           frames;
+  }
+
+  static void Report(StringView name, double micro_seconds, size_t bytes) {
+    Console << name << U": " << micro_seconds << U" us/frame, " << bytes
+            << U" bytes/frame";
+  }
+};
@@ -0,0 +1,19 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+
+#include "flecs/flecs.h"
+
+// フォント名からフォントエンティティを引くための索引を保持するシングルトンCD
+// FontUtil::InitializeFontIndex()で登録したオブザーバーがFontSharedCDの設定・削除に合わせて更新する
+// キーはFontUtil::ToFontId()でフォント名から求めたID
+// ハッシュの衝突で別のフォントを返さないよう、エントリに名前を持たせて検索時に照合する
+struct FontRegistrySingletonCD {
+  struct Entry {
+    String name;
+    flecs::entity entity;
+  };
+
+  HashTable<uint64, Entry> fonts;
+  // エンティティID → 登録しているフォントID（名前が変わったときに古いキーを消すため）
+  HashTable<uint64, uint64> font_ids;
+};
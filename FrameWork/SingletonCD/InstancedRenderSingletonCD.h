@@ -0,0 +1,37 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+
+// インスタンス描画用の定数バッファ（App/Asset/shader/instanced_mesh.hlslのVSInstancesと一致させる）
+struct InstanceBatchCB {
+  // 1回のドローで描画できる最大インスタンス数（定数バッファの上限64KB以内に収める）
+  static constexpr uint32 kMaxInstances = 512;
+
+  struct Instance {
+    Mat4x4 local_to_world;
+    Float4 color;
+  };
+  Instance instances[kMaxInstances];
+};
+
+// 同じメッシュ・テクスチャを使うエンティティの集まり
+struct InstanceGroup {
+  Mesh mesh;
+  Texture tex;  // テクスチャを使わない場合は空
+  Array<InstanceBatchCB::Instance> instances;
+  uint32 idle_frames = 0;  // インスタンスが1つもなかったフレームの連続数
+};
+
+// InstancedRenderingSystemが使うシェーダーと、フレームをまたいで使い回すバッファ
+struct InstancedRenderSingletonCD {
+  VertexShader vs;
+  PixelShader ps;
+  ConstantBuffer<InstanceBatchCB> cb;
+
+  // キーはメッシュとテクスチャのアセットID
+  // 現れたグループはしばらく残してインスタンス配列の容量を使い回し、
+  // kMaxIdleFrames フレーム続けて空だったものは削除する（破棄されたメッシュ・テクスチャを保持し続けないため）
+  static constexpr uint32 kMaxIdleFrames = 120;
+  HashTable<uint64, InstanceGroup> groups;
+
+  bool IsShaderValid() const { return vs && ps; }
+};
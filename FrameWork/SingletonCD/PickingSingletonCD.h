@@ -0,0 +1,31 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+
+#include "Util/SphereBvh.h"
+#include "flecs/flecs.h"
+
+// 3Dピッキングの状態を保持するシングルトンCD
+// PickingSystemが毎フレーム1本のレイでヒット判定を行い、結果をここに残す
+struct PickingSingletonCD {
+  // レイの最大距離
+  float max_distance = 1000.0f;
+
+  // 現在マウスが重なっているエンティティ（無ければ無効なエンティティ）
+  flecs::entity hovered;
+  // ヒットした位置までの距離
+  float hit_distance = 0.0f;
+
+  // PhysXのActorを持たない選択対象のBVH
+  SphereBvh bvh;
+  // trueにすると次のフレームでBVHを作り直す（追加・削除・移動はPickingSystemが変更検出で見つける）
+  bool is_bvh_dirty = true;
+
+  // 呼び出し側が与えるこのフレームのレイとクリック
+  // CameraSingletonCDを持たないworldや、Siv3D以外の入力（ヘッドレス実行のスクリプトなど）で使う
+  // 設定されていればPickingSystemはカメラとマウスの代わりにこれを使う
+  struct Input {
+    Ray ray;
+    bool is_clicked = false;
+  };
+  Optional<Input> input;
+};
@@ -1,14 +1,33 @@
 ﻿#pragma once
+#include <span>
+#include <vector>
+
+#include "PxPhysicsAPI.h"
+#include "Util/FrameProfiler.h"
+#include "Util/PxUtil.h"
 #include "flecs/flecs.h"
 
 // MEMO:オブジェクト指向的になってしまっているが、まあいいや
 class PxDataSingletonCD : public physx::PxSimulationEventCallback {
   public:
-  using OnTriggerHitEvent =
-    std::function<void(flecs::entity, flecs::entity, physx::PxTriggerPair&)>;
-  using OnCollisionHitEvent = std::function<void(
-    flecs::entity, flecs::entity, const physx::PxContactPairHeader&,
-    const physx::PxContactPair&)>;
+  // 接触イベント（PhysXのコールバック中に蓄積し、fetchResults後にまとめて読み出す）
+  struct CollisionEvent {
+    flecs::entity entity0;
+    flecs::entity entity1;
+    physx::PxPairFlags events;  // eNOTIFY_TOUCH_FOUNDなど
+  };
+  // トリガーイベント
+  struct TriggerEvent {
+    flecs::entity trigger;
+    flecs::entity other;
+    physx::PxPairFlag::Enum status;  // eNOTIFY_TOUCH_FOUND / eNOTIFY_TOUCH_LOST
+  };
+  // レイキャストの結果
+  struct RaycastHit {
+    flecs::entity entity;
+    float distance = 0.0f;
+    Vec3 position;
+  };
 
   bool InitializePx() {
     // Foundationのインスタンス化
@@ -55,6 +74,9 @@ class PxDataSingletonCD : public physx::PxSimulationEventCallback {
   }
 
   ~PxDataSingletonCD() {
+    // 実行中のシミュレーションがあれば完了を待ってから解放する
+    FetchSimulation();
+
     for (auto& item : m_material_map) {
       item.second->release();
     }
@@ -82,34 +104,133 @@ class PxDataSingletonCD : public physx::PxSimulationEventCallback {
     }
   }
 
-  void Update(float dt) {
+  // 固定タイムステップの設定
+  // max_substepsは1フレームで進める最大ステップ数で、これを超える経過時間は切り捨てる
+  // （フレーム落ちのたびにステップ数が増えて更に重くなるのを防ぐ）
+  void SetFixedTimestep(float fixed_dt, int max_substeps) {
+    assert(fixed_dt > 0.0f && max_substeps > 0);
+    m_fixed_dt = fixed_dt;
+    m_max_substeps = max_substeps;
+  }
+
+  // 経過時間を積算し、このフレームで進める固定ステップ数を返す
+  int BeginFrame(float dt) {
     if (KeyP.down()) {
       if (m_pPvd) {
         tryConnectPVD(*m_pPvd);
-
-        if (m_pPvd->isConnected()) {
-        }
       }
     }
 
-    // シミュレーション速度を指定する
-    m_pScene->simulate(dt);
+    m_accumulator += dt;
+    const float max_accumulator = m_fixed_dt * static_cast<float>(m_max_substeps);
+    if (m_accumulator > max_accumulator) {
+      m_accumulator = max_accumulator;
+    }
+
+    const int steps = static_cast<int>(m_accumulator / m_fixed_dt);
+    m_accumulator -= m_fixed_dt * static_cast<float>(steps);
+    return steps;
+  }
+
+  // 固定タイムステップで1ステップ進める
+  void Step() {
+    const FrameProfiler::Scope scope{"PhysX::step"};
+    FetchSimulation();
+    m_pScene->simulate(m_fixed_dt);
     // PhysXの処理が終わるまで待つ
     m_pScene->fetchResults(true);
   }
 
+  // 固定タイムステップで1ステップ分のシミュレーションを開始し、完了を待たずに戻る
+  // 結果はFetchSimulation()で受け取る。その間メインスレッドは描画やゲームロジックを進められる
+  void KickSimulation() {
+    FetchSimulation();
+    const FrameProfiler::Scope scope{"PhysX::simulate"};
+    m_pScene->simulate(m_fixed_dt);
+    m_is_simulating = true;
+  }
+
+  // 実行中のシミュレーションの完了を待って結果を反映する（実行中でなければ何もしない）
+  void FetchSimulation() {
+    if (!m_is_simulating) {
+      return;
+    }
+    // メインスレッドがPhysXの完了を待っている時間
+    const FrameProfiler::Scope scope{"PhysX::fetchResults"};
+    m_pScene->fetchResults(true);
+    m_is_simulating = false;
+  }
+
+  // シミュレーションが実行中かどうか
+  bool IsSimulating() const { return m_is_simulating; }
+
+  // 経過時間分だけ固定ステップでシミュレーションを進める
+  void Update(float dt) {
+    const int steps = BeginFrame(dt);
+    for (int i = 0; i < steps; ++i) {
+      Step();
+    }
+  }
+
+  // 描画用の補間係数（直前のステップから次のステップまでの進み具合、0～1）
+  float GetInterpolationAlpha() const { return m_accumulator / m_fixed_dt; }
+  float GetFixedTimestep() const { return m_fixed_dt; }
+
   // 本当はラップするべきだが面倒なので露出させている
   physx::PxPhysics* Physics() { return m_pPhysics; }
+  // シーンの変更はシミュレーション実行中には行えないため、実行中なら完了を待つ
+  // ActorのuserDataには事前にエンティティIDを設定しておく（PxCDHelper::BindEntity）
   bool AddActor(flecs::entity entity, physx::PxActor& actor) {
-    m_actor_entity_map.emplace(&actor, entity);
+    FetchSimulation();
+    assert(PxUtil::GetUserId(actor) == entity.id());
+    m_world = entity.world().c_ptr();
     return m_pScene->addActor(actor);
   }
   void RemoveActor(flecs::entity entity, physx::PxActor& actor) {
-    auto itr = m_actor_entity_map.find(&actor);
-    assert(itr != m_actor_entity_map.end());
-    assert(itr->second == entity);
-    m_actor_entity_map.erase(itr);
+    FetchSimulation();
+    assert(PxUtil::GetUserId(actor) == entity.id());
+    physx::PxAggregate* aggregate = actor.getAggregate();
     m_pScene->removeActor(actor);
+    // 空になったAggregateは一緒に解放する
+    if (aggregate && aggregate->getNbActors() == 0) {
+      m_pScene->removeAggregate(*aggregate);
+      aggregate->release();
+    }
+  }
+
+  // 複数のActorを1回の呼び出しでまとめて追加する（各ActorのuserDataは設定済みであること）
+  bool AddActors(const flecs::world& world,
+                 std::span<physx::PxActor* const> actors) {
+    FetchSimulation();
+    m_world = world.c_ptr();
+    return m_pScene->addActors(actors.data(),
+                               static_cast<physx::PxU32>(actors.size()));
+  }
+
+  // Actorをまとめたアグリゲートを追加する（含まれるActorも同時に追加される）
+  bool AddAggregate(const flecs::world& world, physx::PxAggregate& aggregate) {
+    FetchSimulation();
+    m_world = world.c_ptr();
+    return m_pScene->addAggregate(aggregate);
+  }
+
+  // レイと最初に交差するActorのエンティティを返す（トリガーのシェイプは無視する）
+  // シーンクエリはシミュレーション実行中でも行え、その場合は直前に完了したステップの姿勢が対象になる
+  Optional<RaycastHit> Raycast(const Ray& ray, float max_distance) const {
+    physx::PxRaycastBuffer buffer;
+    const physx::PxQueryFilterData filter_data(
+      physx::PxQueryFlag::eSTATIC | physx::PxQueryFlag::eDYNAMIC |
+      physx::PxQueryFlag::ePREFILTER);
+    IgnoreTriggerFilter filter;
+    if (!m_pScene->raycast(PxUtil::ToVec(Vec3{ray.getOrigin()}),
+                           PxUtil::ToVec(Vec3{ray.getDirection()}), max_distance,
+                           buffer, physx::PxHitFlag::eDEFAULT, filter_data,
+                           &filter) ||
+        !buffer.hasBlock) {
+      return none;
+    }
+    return RaycastHit{ToEntity(*buffer.block.actor), buffer.block.distance,
+                      PxUtil::ToSivVec(buffer.block.position)};
   }
 
   physx::PxMaterial* GetDefaultMat() { return GetMat(kDefaultMatName.data()); }
@@ -133,23 +254,45 @@ class PxDataSingletonCD : public physx::PxSimulationEventCallback {
     m_material_map.emplace(name, default_mat);
   }
 
-  void AddOnTriggerHitEvent(OnTriggerHitEvent&& ev) {
-    m_on_trigger_hit_event.push_back(ev);
+  // 前回のClearEvents()以降に蓄積されたイベント
+  // PhysicsSystemがPxEventSingletonCDへ変換してからClearEvents()する
+  std::span<const TriggerEvent> GetTriggerEvents() const {
+    return m_trigger_buffer;
+  }
+  std::span<const CollisionEvent> GetCollisionEvents() const {
+    return m_collision_buffer;
   }
-  void AddOnCollisionHitEvent(OnCollisionHitEvent&& ev) {
-    m_on_collision_hit_event.push_back(ev);
+  void ClearEvents() {
+    m_trigger_buffer.clear();
+    m_collision_buffer.clear();
   }
 
+  // PhysXのコールバック内ではIDの読み出しとバッファへの追加のみ行う
   void onTrigger(physx::PxTriggerPair* pairs, physx::PxU32 count) override {
     for (physx::PxU32 i = 0; i < count; i++) {
-      callOnTriggerHitEvent(pairs[i]);
+      const physx::PxTriggerPair& pair = pairs[i];
+      // 削除済みのShapeを含むペアはActorが無効なため無視
+      if (pair.flags & (physx::PxTriggerPairFlag::eREMOVED_SHAPE_TRIGGER |
+                        physx::PxTriggerPairFlag::eREMOVED_SHAPE_OTHER)) {
+        continue;
+      }
+      m_trigger_buffer.push_back(
+        {ToEntity(*pair.triggerActor), ToEntity(*pair.otherActor),
+         pair.status});
     }
   }
   void onContact(const physx::PxContactPairHeader& header,
                  const physx::PxContactPair* pairs,
                  physx::PxU32 count) override {
+    // 削除済みのActorを含むペアは無視
+    if (header.flags & (physx::PxContactPairHeaderFlag::eREMOVED_ACTOR_0 |
+                        physx::PxContactPairHeaderFlag::eREMOVED_ACTOR_1)) {
+      return;
+    }
+    const flecs::entity entity0 = ToEntity(*header.actors[0]);
+    const flecs::entity entity1 = ToEntity(*header.actors[1]);
     for (physx::PxU32 i = 0; i < count; i++) {
-      callOnCollisionHitEvent(header, pairs[i]);
+      m_collision_buffer.push_back({entity0, entity1, pairs[i].events});
     }
   }
   void onConstraintBreak(physx::PxConstraintInfo*, physx::PxU32) override {}
@@ -168,9 +311,16 @@ class PxDataSingletonCD : public physx::PxSimulationEventCallback {
     physx::PxFilterObjectAttributes attributes1,
     physx::PxFilterData filterData1, physx::PxPairFlags& pairFlags,
     const void* constantBlock, physx::PxU32 constantBlockSize) {
-    // コリジョン検出のペアフラグを設定
+    // トリガーを含むペアはトリガー用のフラグにする（onTriggerで通知される）
+    if (physx::PxFilterObjectIsTrigger(attributes0) ||
+        physx::PxFilterObjectIsTrigger(attributes1)) {
+      pairFlags = physx::PxPairFlag::eTRIGGER_DEFAULT;
+      return physx::PxFilterFlag::eDEFAULT;
+    }
+    // コリジョン検出のペアフラグを設定（接触の開始と終了を通知する）
     pairFlags = physx::PxPairFlag::eCONTACT_DEFAULT |
-                physx::PxPairFlag::eNOTIFY_TOUCH_FOUND;
+                physx::PxPairFlag::eNOTIFY_TOUCH_FOUND |
+                physx::PxPairFlag::eNOTIFY_TOUCH_LOST;
     return physx::PxFilterFlag::eDEFAULT;
   }
 
@@ -180,35 +330,27 @@ class PxDataSingletonCD : public physx::PxSimulationEventCallback {
   static constexpr StringView kDefaultMatName = U"DefaultMat";
   static constexpr StringView kZeroFrictionMatName = U"ZeroMat";
 
-  void callOnTriggerHitEvent(physx::PxTriggerPair& pair) {
-    auto trigger_actor_itr = m_actor_entity_map.find(pair.triggerActor);
-    if (trigger_actor_itr == m_actor_entity_map.end()) {
-      return;
-    }
-    auto other_actor_itr = m_actor_entity_map.find(pair.otherActor);
-    if (other_actor_itr == m_actor_entity_map.end()) {
-      return;
+  // ピッキングでトリガーのシェイプに当たらないようにするフィルター
+  struct IgnoreTriggerFilter : public physx::PxQueryFilterCallback {
+    physx::PxQueryHitType::Enum preFilter(const physx::PxFilterData&,
+                                          const physx::PxShape* shape,
+                                          const physx::PxRigidActor*,
+                                          physx::PxHitFlags&) override {
+      return (shape->getFlags() & physx::PxShapeFlag::eTRIGGER_SHAPE)
+               ? physx::PxQueryHitType::eNONE
+               : physx::PxQueryHitType::eBLOCK;
     }
-
-    for (auto& ev : m_on_trigger_hit_event) {
-      ev(trigger_actor_itr->second, other_actor_itr->second, pair);
+    physx::PxQueryHitType::Enum postFilter(const physx::PxFilterData&,
+                                           const physx::PxQueryHit&,
+                                           const physx::PxShape*,
+                                           const physx::PxRigidActor*) override {
+      return physx::PxQueryHitType::eBLOCK;
     }
-  }
+  };
 
-  void callOnCollisionHitEvent(const physx::PxContactPairHeader& header,
-                               const physx::PxContactPair& pair) {
-    auto hit_actor_itr = m_actor_entity_map.find(header.actors[0]);
-    if (hit_actor_itr == m_actor_entity_map.end()) {
-      return;
-    }
-    auto other_hit_actor_itr = m_actor_entity_map.find(header.actors[1]);
-    if (other_hit_actor_itr == m_actor_entity_map.end()) {
-      return;
-    }
-
-    for (auto& ev : m_on_collision_hit_event) {
-      ev(hit_actor_itr->second, other_hit_actor_itr->second, header, pair);
-    }
+  // userDataに埋め込んだIDからエンティティを作る（ハッシュ検索なし）
+  flecs::entity ToEntity(const physx::PxActor& actor) const {
+    return flecs::entity(m_world, PxUtil::GetUserId(actor));
   }
 
   static void tryConnectPVD(physx::PxPvd& pvd) {
@@ -257,8 +399,18 @@ class PxDataSingletonCD : public physx::PxSimulationEventCallback {
   bool is_pvd_camera_sync = false;
 
   bool is_ext_initialized = false;
+  // 固定タイムステップ
+  float m_fixed_dt = 1.0f / 60.0f;
+  // 1フレームで進める最大ステップ数
+  int m_max_substeps = 4;
+  // 未消化の経過時間
+  float m_accumulator = 0.0f;
+  // KickSimulation()で開始したシミュレーションが実行中ならtrue
+  bool m_is_simulating = false;
   std::unordered_map<String, physx::PxMaterial*> m_material_map = {};
-  std::vector<OnTriggerHitEvent> m_on_trigger_hit_event;
-  std::vector<OnCollisionHitEvent> m_on_collision_hit_event;
-  std::unordered_map<physx::PxActor*, flecs::entity> m_actor_entity_map;
+  // ステップ中に発生したイベント（容量は使い回す）
+  std::vector<TriggerEvent> m_trigger_buffer;
+  std::vector<CollisionEvent> m_collision_buffer;
+  // Actorが属するワールド（userDataのIDからエンティティを作るため）
+  flecs::world_t* m_world = nullptr;
 };
@@ -0,0 +1,68 @@
+﻿#pragma once
+#include <span>
+#include <vector>
+
+#include "flecs/flecs.h"
+
+// 物理イベント1ペア分
+// 接触イベントはselfとotherを入れ替えた2件が両方登録されるため、selfだけを見ればよい
+// トリガーイベントはselfがトリガー側
+struct PxEventPair {
+  flecs::entity self;
+  flecs::entity other;
+};
+
+// このフレームに発生した物理イベントを種類ごとに連続配列で保持するシングルトンCD
+// PhysicsSystemのphys_event_sysが毎フレーム作り直す
+// 同じステップ中に削除されたエンティティを含むイベントは含まれない（selfもotherも必ずis_alive()）
+// ゲームロジック側のシステムはこのシングルトンを読み取って一括で処理する
+//   world.system<const PxEventSingletonCD>().each([](const PxEventSingletonCD& ev) {
+//     for (const auto& pair : ev.trigger_enter) { ... }
+//   });
+struct PxEventSingletonCD {
+  std::vector<PxEventPair> collision_enter;
+  std::vector<PxEventPair> collision_exit;
+  std::vector<PxEventPair> trigger_enter;
+  std::vector<PxEventPair> trigger_stay;
+  std::vector<PxEventPair> trigger_exit;
+
+  // 接触中のトリガーペア（フレームをまたいで保持し、stayとexitの判定に使う）
+  std::vector<PxEventPair> active_triggers;
+  // stay判定用に、フレーム開始時点のactive_triggersを写す作業用バッファ（容量は使い回す）
+  std::vector<PxEventPair> prev_active_triggers;
+  // Shapeの削除で接触が切れたペア（PhysXは削除済みShapeのペアを通知しないため、
+  // PhysicsSystemのオブザーバーが積み、次のBuildEventsでexitとして通知する）
+  std::vector<PxEventPair> detached_triggers;
+
+  // フレームごとのイベントをクリア（容量は使い回す）
+  void Clear() {
+    collision_enter.clear();
+    collision_exit.clear();
+    trigger_enter.clear();
+    trigger_stay.clear();
+    trigger_exit.clear();
+  }
+};
+
+// イベントが1件以上あるフレームに、種類ごとに1回だけworld.eventで通知される
+// ペイロードはPxEventSingletonCDの該当する配列（通知中のみ有効）
+// 監視側はオブザーバーで一括して受け取る
+//   world.observer<PxEventSingletonCD>().event<TriggerEnterEvent>()
+//     .each([](flecs::iter& it, size_t, PxEventSingletonCD&) {
+//       for (const auto& pair : it.param<TriggerEnterEvent>()->pairs) { ... }
+//     });
+struct CollisionEnterEvent {
+  std::span<const PxEventPair> pairs;
+};
+struct CollisionExitEvent {
+  std::span<const PxEventPair> pairs;
+};
+struct TriggerEnterEvent {
+  std::span<const PxEventPair> pairs;
+};
+struct TriggerStayEvent {
+  std::span<const PxEventPair> pairs;
+};
+struct TriggerExitEvent {
+  std::span<const PxEventPair> pairs;
+};
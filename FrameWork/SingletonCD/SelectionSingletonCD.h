@@ -0,0 +1,32 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+
+#include "CD/SelectingTagCD.h"
+#include "Util/CircleGrid.h"
+#include "flecs/flecs.h"
+
+// 選択状態を保持するシングルトンCD
+// SelectingTagCDを持つエンティティは常にselectedの1つだけなので、切り替えはO(1)で行える
+// 2DのSelectableCD::areaの空間索引もここに置く（HoverSystemが管理する）
+struct SelectionSingletonCD {
+  // 現在選択中のエンティティ（無ければ無効なエンティティ）
+  flecs::entity selected;
+  // 2Dでマウスが重なっているエンティティ（無ければ無効なエンティティ）
+  flecs::entity hovered;
+  // SelectableCD::areaの索引（キーはエンティティID）
+  CircleGrid grid;
+
+  // 選択を切り替える（前の選択からSelectingTagCDを外し、新しい選択に付ける）
+  void Select(flecs::entity e) {
+    if (selected == e) {
+      return;
+    }
+    if (selected && selected.is_alive()) {
+      selected.remove<SelectingTagCD>();
+    }
+    if (e) {
+      e.add<SelectingTagCD>();
+    }
+    selected = e;
+  }
+};
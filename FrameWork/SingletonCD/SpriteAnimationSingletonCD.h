@@ -0,0 +1,12 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+
+#include "Util/TimerWheel.h"
+
+// スプライトアニメーションのフレーム切り替え予定を管理するシングルトンCD
+struct SpriteAnimationSingletonCD {
+  // キーはエンティティID
+  TimerWheel wheel;
+  // ホイール作成からの経過時間（秒）
+  double time = 0.0;
+};
@@ -0,0 +1,10 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+
+#include "Util/SpriteAtlas.h"
+
+// スプライト用のアトラスを保持するシングルトンCD
+// EntityFactoryがスプライトの生成時に画像を詰め込み、SpriteRenderingSystemが描画前に転送する
+struct SpriteAtlasSingletonCD {
+  SpriteAtlas atlas;
+};
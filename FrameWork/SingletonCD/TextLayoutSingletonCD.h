@@ -0,0 +1,10 @@
+﻿#pragma once
+#include <vector>
+
+#include "flecs/flecs.h"
+
+// レイアウトの作り直しが必要なテキストエンティティの一覧
+// TextUISystemのオブザーバーが変更を検出して追加し、次の描画前にまとめて作り直す
+struct TextLayoutSingletonCD {
+  std::vector<flecs::entity> dirty;
+};
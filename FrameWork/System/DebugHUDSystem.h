@@ -2,6 +2,7 @@
 #include <Siv3D.hpp>
 
 #include "FrameWork/Util/FontUtil.h"  // FontUtilのユーティリティを利用
+#include "FrameWork/Util/FrameProfiler.h"
 #include "FrameWork/flecs/flecs.h"
 
 // デバッグHUD表示用のシステムクラス
@@ -24,9 +25,11 @@ class DebugHUDSystem {
     constexpr int lineHeight = static_cast<int>(fontSize * 1.4);
     int y = padding;
 
-    // StandardFontをFontUtilで取得
-    flecs::entity fontEntity = FontUtil::FindFontCD(world, U"StandardFont");
-    const FontSharedCD* fontCD = fontEntity.get<FontSharedCD>();
+    // StandardFontをFontUtilで取得（コンパイル時に求めたIDで索引を引き、名前を照合する）
+    flecs::entity fontEntity = FontUtil::FindFontCD(
+      world, FontUtil::StandardFontId, FontUtil::StandardFontName);
+    const FontSharedCD* fontCD =
+      fontEntity ? fontEntity.try_get<FontSharedCD>() : nullptr;
     if (!fontCD) {
       // フォントが見つからない場合は何も描画しない
       return;
@@ -64,6 +67,11 @@ class DebugHUDSystem {
                          Palette::Black);
     y += lineHeight;
 
+    // FrameProfilerが有効なら、処理ごとの時間をHUDの下に表示
+    if (FrameProfiler::IsEnabled()) {
+      FrameProfiler::DrawOverlay(font, Vec2(padding, y));
+    }
+
     // その他のHUD情報もここに追加可能
   }
 };
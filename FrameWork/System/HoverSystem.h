@@ -1,27 +1,57 @@
 ﻿
-
 #pragma once
 #include "FrameWork/CD/HoveringTagCD.h"
 #include "FrameWork/CD/SelectableCD.h"
+#include "FrameWork/SingletonCD/SelectionSingletonCD.h"
 #include "FrameWork/flecs/flecs.h"
 
 class HoverSystem {
   public:
+  // SelectSystemからも呼ばれるため、2回目以降の呼び出しでは何もしない
   static void Register(flecs::world& world) {
-    // SelectableCDを持つentityをイテレートして、
-    // SelectableCD::areaにマウスがホバーしていたらHoveringTagCDを追加/削除するsystemを登録
-    world.system<const SelectableCD>("hovering_tag_update_sys")
-      .without(flecs::Prefab)
-      .each([&world](flecs::entity e, const SelectableCD& selectable) {
-        if (selectable.area.mouseOver()) {
-          if (!e.has<HoveringTagCD>()) {
-            world.defer([e]() { e.add<HoveringTagCD>(); });
-          }
-        } else {
-          if (e.has<HoveringTagCD>()) {
-            world.defer([e]() { e.remove<HoveringTagCD>(); });
-          }
+    if (world.lookup("hovering_tag_update_sys")) {
+      return;
+    }
+    // PickingSystemが先に作成している場合もある
+    world.add<SelectionSingletonCD>();
+
+    // SelectableCD::areaが設定・変更されたときだけ空間索引を更新する
+    // areaを直接書き換えた場合はmodified<SelectableCD>()を呼ぶこと
+    world.observer<const SelectableCD>("selectable_index_set_obs")
+      .event(flecs::OnSet)
+      .each([](flecs::entity e, const SelectableCD& selectable) {
+        GetSelection(e.world()).grid.Set(e.id(), selectable.area);
+      });
+    world.observer<const SelectableCD>("selectable_index_remove_obs")
+      .event(flecs::OnRemove)
+      .each([](flecs::entity e, const SelectableCD&) {
+        GetSelection(e.world()).grid.Remove(e.id());
+      });
+
+    // マウス位置で1回だけ索引を引き、重なっているentityにHoveringTagCDを付ける
+    // 前フレームの対象とは入れ替えるだけなので、SelectableCDの数によらず一定のコスト
+    world.system<SelectionSingletonCD>("hovering_tag_update_sys")
+      .kind(flecs::PreUpdate)
+      .each([](flecs::entity e, SelectionSingletonCD& selection) {
+        flecs::entity hit;
+        if (const auto id = selection.grid.FindAt(Cursor::PosF())) {
+          hit = flecs::entity(e.world(), *id);
         }
+        if (hit == selection.hovered) {
+          return;
+        }
+        if (selection.hovered && selection.hovered.is_alive()) {
+          selection.hovered.remove<HoveringTagCD>();
+        }
+        if (hit && hit.is_alive()) {
+          hit.add<HoveringTagCD>();
+        }
+        selection.hovered = hit;
       });
   }
-};
\ No newline at end of file
+
+  private:
+  static SelectionSingletonCD& GetSelection(flecs::world world) {
+    return *world.get_ref<SelectionSingletonCD>().get();
+  }
+};
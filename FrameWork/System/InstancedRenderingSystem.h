@@ -0,0 +1,131 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+
+#include "CD/ColorCD.h"
+#include "CD/MeshCD.h"
+#include "CD/PositionCD.h"
+#include "CD/RotationCD.h"
+#include "CD/TextureCD.h"
+#include "SingletonCD/InstancedRenderSingletonCD.h"
+#include "flecs/flecs.h"
+
+// MeshCDを持つエンティティを (メッシュ, テクスチャ) ごとにまとめてインスタンス描画するシステム
+// ドローコール数はエンティティ数ではなく、メッシュとテクスチャの組み合わせの数に比例する
+// EntityFactoryはサイズごと・パスごとにメッシュとテクスチャを共有しているため、同じプレハブはまとめて描画される
+// テクスチャを持つメッシュは従来どおりColorCDで色を付けず、テクスチャの色のまま描画する
+// シェーダーの読み込みに失敗した場合は従来どおりエンティティごとに描画する
+class InstancedRenderingSystem {
+  public:
+  static constexpr StringView kShaderPath = U"Asset/shader/instanced_mesh.hlsl";
+
+  static void Register(flecs::world& world) {
+    InstancedRenderSingletonCD render;
+    render.vs = HLSL{kShaderPath, U"VS"};
+    render.ps = HLSL{kShaderPath, U"PS"};
+    if (!render.IsShaderValid()) {
+      s3d::Console << U"InstancedRenderingSystem: シェーダーの読み込みに失敗しました";
+    }
+    world.set<InstancedRenderSingletonCD>(std::move(render));
+
+    // ColorCDとTextureCDは任意（どちらも持たないエンティティは描画しない）
+    auto mesh_query =
+      world
+        .query_builder<const PositionCD, const RotationCD, const MeshCD,
+                       const ColorCD*, const TextureCD*>()
+        .without(flecs::Prefab)
+        .build();
+
+    auto instanced_mesh_draw_sys =
+      world.system<InstancedRenderSingletonCD>("instanced_mesh_draw_sys")
+        .kind(flecs::PreStore)
+        .each([mesh_query](InstancedRenderSingletonCD& render) {
+          if (!render.IsShaderValid()) {
+            DrawEach(mesh_query);
+            return;
+          }
+          Gather(mesh_query, render);
+          DrawGroups(render);
+        });
+  }
+
+  private:
+  static uint64 MakeKey(const Mesh& mesh, const Texture& tex) {
+    return (static_cast<uint64>(mesh.id().value()) << 32) |
+           static_cast<uint64>(tex.id().value());
+  }
+
+  // エンティティをグループごとに振り分ける
+  template <typename Query>
+  static void Gather(const Query& mesh_query,
+                     InstancedRenderSingletonCD& render) {
+    EvictIdleGroups(render);
+
+    mesh_query.each([&render](const PositionCD& pos, const RotationCD& rot,
+                              const MeshCD& mesh, const ColorCD* color,
+                              const TextureCD* tex) {
+      if (!color && !tex) {
+        return;
+      }
+      // テクスチャを持たない場合は空のテクスチャのアセットIDでまとめる
+      const Texture texture = tex ? tex->tex : Texture{};
+      auto& group = render.groups[MakeKey(mesh.mesh, texture)];
+      if (!group.mesh) {
+        group.mesh = mesh.mesh;
+        group.tex = texture;
+      }
+      // テクスチャ付きのメッシュは色を乗算しない
+      const ColorF tint = (tex || !color) ? ColorF{Palette::White} : ColorF{color->c};
+      group.instances.push_back(
+        {Mat4x4::Rotate(rot.rot).translated(pos.pos), tint.toFloat4()});
+    });
+  }
+
+  // 前フレームのインスタンスを空にし、長く使われていないグループを削除する
+  static void EvictIdleGroups(InstancedRenderSingletonCD& render) {
+    for (auto it = render.groups.begin(); it != render.groups.end();) {
+      InstanceGroup& group = it->second;
+      group.idle_frames = group.instances.empty() ? group.idle_frames + 1 : 0;
+      if (group.idle_frames > InstancedRenderSingletonCD::kMaxIdleFrames) {
+        render.groups.erase(it++);
+        continue;
+      }
+      group.instances.clear();
+      ++it;
+    }
+  }
+
+  // グループごとにkMaxInstances個ずつ定数バッファへ書き込んで描画する
+  static void DrawGroups(InstancedRenderSingletonCD& render) {
+    const ScopedCustomShader3D shader{render.vs, render.ps};
+    for (const auto& [key, group] : render.groups) {
+      const auto& instances = group.instances;
+      for (size_t begin = 0; begin < instances.size();
+           begin += InstanceBatchCB::kMaxInstances) {
+        const uint32 count = static_cast<uint32>(Min<size_t>(
+          InstanceBatchCB::kMaxInstances, instances.size() - begin));
+        std::copy_n(instances.begin() + begin, count,
+                    render.cb->instances);
+        Graphics3D::SetVSConstantBuffer(4, render.cb);
+        if (group.tex) {
+          group.mesh.drawInstanced(count, group.tex);
+        } else {
+          group.mesh.drawInstanced(count);
+        }
+      }
+    }
+  }
+
+  // シェーダーが使えない場合のエンティティごとの描画
+  template <typename Query>
+  static void DrawEach(const Query& mesh_query) {
+    mesh_query.each([](const PositionCD& pos, const RotationCD& rot,
+                       const MeshCD& mesh, const ColorCD* color,
+                       const TextureCD* tex) {
+      if (tex) {
+        mesh.mesh.draw(pos.pos, rot.rot, tex->tex);
+      } else if (color) {
+        mesh.mesh.draw(pos.pos, rot.rot, color->c);
+      }
+    });
+  }
+};
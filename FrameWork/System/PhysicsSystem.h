@@ -4,23 +4,249 @@
 #include "CD/RotationCD.h"
 #include "Helper/PxCDHelper.h"
 #include "SingletonCD/PxDataSingletonCD.h"
+#include "SingletonCD/PxEventSingletonCD.h"
 #include "flecs/flecs.h"
 
 class PhysicsSystem {
   public:
   static void Register(flecs::world& world) {
-    auto phys_sys = world.system<PxDataSingletonCD>("phys_sys")
-                      .kind(flecs::PostUpdate)
-                      .each([](PxDataSingletonCD& px) {
-                        px.Update(static_cast<float>(Scene::DeltaTime()));
-                      });
+    world.add<PxEventSingletonCD>();
+
+    // Shapeが外されたペアはPhysXから通知されないため、ここでexit用に退避する
+    world.observer<PxShapeCD>()
+      .event(flecs::OnRemove)
+      .each([](flecs::entity e, PxShapeCD&) {
+        flecs::world observer_world = e.world();
+        DetachTriggerPairs(observer_world, e);
+      });
+    world.observer<DynamicBodyCD>()
+      .event(flecs::OnRemove)
+      .each([](flecs::entity e, DynamicBodyCD&) {
+        flecs::world observer_world = e.world();
+        DetachTriggerPairs(observer_world, e);
+      });
+    world.observer<StaticBodyCD>()
+      .event(flecs::OnRemove)
+      .each([](flecs::entity e, StaticBodyCD&) {
+        flecs::world observer_world = e.world();
+        DetachTriggerPairs(observer_world, e);
+      });
+
+    // 補間用に、最後の固定ステップを進める前の姿勢を保存するクエリ
+    auto capture_query =
+      world.query_builder<const DynamicBodyCD, PxInterpolationCD>()
+        .without(flecs::Prefab)
+        .build();
+
+    // 物理演算はフレームをまたいで非同期に実行する（1フレームの遅延あり）
+    //   フレームN   PostUpdate末尾: phys_kick_sys がsimulate()を開始
+    //   フレームN+1 OnUpdateなど  : ゲームロジックと描画はPhysXと並行に進む
+    //                                （この間の読み取りはフレームN時点の姿勢になる）
+    //   フレームN+1 PostUpdate先頭: phys_fetch_sys が結果を受け取り、post_phys_sysで反映
+    auto phys_fetch_sys = world.system<PxDataSingletonCD>("phys_fetch_sys")
+                            .kind(flecs::PostUpdate)
+                            .each([](PxDataSingletonCD& px) {
+                              px.FetchSimulation();
+                            });
+
+    // PhysXのイベントをPxEventSingletonCDに集約し、種類ごとに1回だけ通知する
+    auto phys_event_sys =
+      world.system<PxDataSingletonCD>("phys_event_sys")
+        .kind(flecs::PostUpdate)
+        .each([](flecs::entity e, PxDataSingletonCD& px) {
+          flecs::world event_world = e.world();
+          PxEventSingletonCD& events =
+            *event_world.get_ref<PxEventSingletonCD>().get();
+          BuildEvents(px, events);
+          px.ClearEvents();
+          EmitEvents(event_world, events);
+        });
+
+    // 直前のステップと現在のステップの姿勢を補間して描画用の位置・回転に反映
+    // fetch後のgetGlobalPose()は読み取りのみなので、ワーカースレッドで分割実行する
     auto post_phys_sys =
-      world.system<PositionCD, RotationCD, DynamicBodyCD>("post_phys_sys")
+      world
+        .system<PositionCD, RotationCD, const DynamicBodyCD,
+                const PxInterpolationCD, const PxDataSingletonCD>(
+          "post_phys_sys")
+        .term_at(4)
+        .src<PxDataSingletonCD>()
+        .kind(flecs::PostUpdate)
+        .without(flecs::Prefab)
+        .multi_threaded()
+        .each([](PositionCD& pos, RotationCD& rot, const DynamicBodyCD& body,
+                 const PxInterpolationCD& interp,
+                 const PxDataSingletonCD& px) {
+          PxCDHelper::ToPosRotInterpolated(interp.previous,
+                                           body.rigid->getGlobalPose(),
+                                           px.GetInterpolationAlpha(), pos,
+                                           rot);
+        });
+
+    // 補間用CDを持たないボディは最新の姿勢をそのまま反映
+    auto post_phys_raw_sys =
+      world.system<PositionCD, RotationCD, DynamicBodyCD>("post_phys_raw_sys")
         .kind(flecs::PostUpdate)
         .without(flecs::Prefab)
+        .multi_threaded()
+        .without<PxInterpolationCD>()
         .each([](PositionCD& pos, RotationCD& rot, DynamicBodyCD& body) {
           auto body_transform = body.rigid->getGlobalPose();
           PxCDHelper::ToPosRot(body_transform, pos, rot);
         });
+
+    // 結果の反映後に次のステップを開始する（同じフェーズ内では登録順に実行される）
+    // 遅れを取り戻すための追加ステップはここで同期的に進め、最後の1ステップだけを非同期にする
+    auto phys_kick_sys =
+      world.system<PxDataSingletonCD>("phys_kick_sys")
+        .kind(flecs::PostUpdate)
+        .each([capture_query](PxDataSingletonCD& px) {
+          const int steps =
+            px.BeginFrame(static_cast<float>(Scene::DeltaTime()));
+          if (steps <= 0) {
+            return;
+          }
+          for (int i = 0; i < steps - 1; ++i) {
+            px.Step();
+          }
+          capture_query.each(
+            [](const DynamicBodyCD& body, PxInterpolationCD& interp) {
+              interp.previous = body.rigid->getGlobalPose();
+            });
+          px.KickSimulation();
+        });
+  }
+
+  private:
+  // PhysXから受け取ったイベントをフレーム単位のイベント配列に変換
+  static void BuildEvents(const PxDataSingletonCD& px,
+                          PxEventSingletonCD& events) {
+    events.Clear();
+
+    // 同じステップ中に削除されたエンティティを含むイベントは通知しない
+    // （受け取り側に削除済みのエンティティを渡さない。削除はOnRemoveで検知すること）
+    for (const auto& c : px.GetCollisionEvents()) {
+      if (!IsPairAlive({c.entity0, c.entity1})) {
+        continue;
+      }
+      if (c.events & physx::PxPairFlag::eNOTIFY_TOUCH_FOUND) {
+        events.collision_enter.push_back({c.entity0, c.entity1});
+        events.collision_enter.push_back({c.entity1, c.entity0});
+      }
+      if (c.events & physx::PxPairFlag::eNOTIFY_TOUCH_LOST) {
+        events.collision_exit.push_back({c.entity0, c.entity1});
+        events.collision_exit.push_back({c.entity1, c.entity0});
+      }
+    }
+
+    // stay判定のため、このフレームの開始時点で接触していたペアを覚えておく
+    // 接触中のトリガーペアは少数の想定なので線形探索で扱う
+    events.prev_active_triggers.assign(events.active_triggers.begin(),
+                                       events.active_triggers.end());
+
+    // Shapeの削除で切れたペアは、前回のフレーム以降に接触を離れたものとして扱う
+    for (const auto& p : events.detached_triggers) {
+      if (IsPairAlive(p) && IsTriggerEnabled(p.self)) {
+        events.trigger_exit.push_back(p);
+      }
+    }
+    events.detached_triggers.clear();
+
+    // 無効化されたトリガーでもactive_triggersの出入りは必ず反映し、通知だけを止める
+    // （無効中に離れたペアがactive_triggersに残り続けないようにする）
+    for (const auto& t : px.GetTriggerEvents()) {
+      const PxEventPair pair{t.trigger, t.other};
+      if (!IsPairAlive(pair)) {
+        continue;
+      }
+      const bool enabled = IsTriggerEnabled(t.trigger);
+      if (t.status == physx::PxPairFlag::eNOTIFY_TOUCH_FOUND) {
+        if (enabled) {
+          events.trigger_enter.push_back(pair);
+        }
+        events.active_triggers.push_back(pair);
+      } else if (t.status == physx::PxPairFlag::eNOTIFY_TOUCH_LOST) {
+        if (enabled) {
+          events.trigger_exit.push_back(pair);
+        }
+        EraseTriggerPairs(events.active_triggers, pair);
+      }
+    }
+
+    // 削除されたエンティティを含むペアは通知せずに取り除く
+    std::erase_if(events.active_triggers,
+                  [](const PxEventPair& p) { return !IsPairAlive(p); });
+
+    // フレーム開始前から接触し続けているペアがstay
+    for (const auto& p : events.active_triggers) {
+      if (!IsTriggerEnabled(p.self)) {
+        continue;
+      }
+      for (const auto& prev : events.prev_active_triggers) {
+        if (p.self == prev.self && p.other == prev.other) {
+          events.trigger_stay.push_back(p);
+          break;
+        }
+      }
+    }
+  }
+
+  // TriggerCDを持たないトリガーは常に有効
+  // 生存しているかどうかはIsPairAlive()で確認してから呼ぶ
+  static bool IsTriggerEnabled(flecs::entity trigger) {
+    const auto* trigger_cd = trigger.try_get<TriggerCD>();
+    return !trigger_cd || trigger_cd->isEnabled;
+  }
+
+  static bool IsPairAlive(const PxEventPair& pair) {
+    return pair.self.is_alive() && pair.other.is_alive();
+  }
+
+  static void EraseTriggerPairs(std::vector<PxEventPair>& pairs,
+                                const PxEventPair& pair) {
+    std::erase_if(pairs, [&pair](const PxEventPair& p) {
+      return p.self == pair.self && p.other == pair.other;
+    });
+  }
+
+  // ShapeやBodyが外されたとき、そのエンティティを含む接触中のペアをdetached_triggersへ移す
+  // エンティティが生きたままShapeだけ外された場合は、次のBuildEventsでexitが通知される
+  // （エンティティごと削除された場合は、削除済みのエンティティを渡さないよう通知しない）
+  static void DetachTriggerPairs(flecs::world& world, flecs::entity e) {
+    // ワールド破棄中はシングルトンが先に消えていることがある
+    PxEventSingletonCD* events = world.get_ref<PxEventSingletonCD>().get();
+    if (!events) {
+      return;
+    }
+    std::erase_if(events->active_triggers, [events, e](const PxEventPair& p) {
+      if (p.self != e && p.other != e) {
+        return false;
+      }
+      events->detached_triggers.push_back(p);
+      return true;
+    });
+  }
+
+  // 空でないイベント配列ごとに1回だけ通知する（リスナー数に比例するコスト）
+  template <typename Event>
+  static void EmitEvent(flecs::world& world,
+                        const std::vector<PxEventPair>& pairs) {
+    if (pairs.empty()) {
+      return;
+    }
+    world.event<Event>()
+      .template id<PxEventSingletonCD>()
+      .entity(world.component<PxEventSingletonCD>())
+      .ctx(Event{pairs})
+      .emit();
+  }
+
+  static void EmitEvents(flecs::world& world,
+                         const PxEventSingletonCD& events) {
+    EmitEvent<CollisionEnterEvent>(world, events.collision_enter);
+    EmitEvent<CollisionExitEvent>(world, events.collision_exit);
+    EmitEvent<TriggerEnterEvent>(world, events.trigger_enter);
+    EmitEvent<TriggerStayEvent>(world, events.trigger_stay);
+    EmitEvent<TriggerExitEvent>(world, events.trigger_exit);
   }
 };
@@ -0,0 +1,128 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+#include <vector>
+
+#include "CD/HoveringTagCD.h"
+#include "CD/PickableCD.h"
+#include "CD/PositionCD.h"
+#include "CD/PxCD.h"
+#include "CD/SelectingTagCD.h"
+#include "SingletonCD/CameraSingletonCD.h"
+#include "SingletonCD/PickingSingletonCD.h"
+#include "SingletonCD/PxDataSingletonCD.h"
+#include "SingletonCD/SelectionSingletonCD.h"
+#include "flecs/flecs.h"
+
+// 3D空間のPickableCDを持つエンティティをマウスで選択するシステム
+// 1フレームにつきカメラからのレイを1本だけ飛ばし、最も近いヒットにHoveringTagCD、
+// クリックされたらSelectingTagCDを付ける
+//   PhysXのActorを持つ対象 : PxScene::raycast（PickableCDを持たないActorは遮蔽物として扱う）
+//   Actorを持たない対象    : PickingSingletonCDのBVH
+// どちらも対象数に対して対数時間で判定できる
+// レイはCameraSingletonCDのカメラとマウスから作る（PickingSingletonCD::inputが設定されていればそれを使う）
+class PickingSystem {
+  public:
+  static void Register(flecs::world& world) {
+    world.add<PickingSingletonCD>();
+    // 選択中のエンティティは2DのSelectSystemと共有する
+    world.add<SelectionSingletonCD>();
+
+    // BVHに入れる対象（PhysXのActorを持たないもの）
+    // 変更検出で、対象の追加・削除・移動（システムやset()によるPositionCDの書き込み）があったときだけBVHを作り直す
+    // PositionCDをget_mut()などで直接書き換えた場合はmodified<PositionCD>()を呼ぶこと
+    auto bvh_query = world.query_builder<const PickableCD, const PositionCD>()
+                       .without<StaticBodyCD>()
+                       .without<DynamicBodyCD>()
+                       .without(flecs::Prefab)
+                       .cached()
+                       .detect_changes()
+                       .build();
+
+    // ゲームロジックより先にタグを確定させる
+    auto picking_sys =
+      world.system<PickingSingletonCD>("picking_sys")
+        .kind(flecs::PreUpdate)
+        .each([bvh_query](flecs::entity e, PickingSingletonCD& picking) {
+          flecs::world world = e.world();
+          if (picking.is_bvh_dirty || bvh_query.changed()) {
+            RebuildBvh(bvh_query, picking);
+          }
+
+          Ray ray;
+          bool is_clicked = false;
+          if (picking.input) {
+            ray = picking.input->ray;
+            is_clicked = picking.input->is_clicked;
+          } else if (const auto* camera = world.try_get<CameraSingletonCD>()) {
+            ray = camera->camera.screenToRay(Cursor::Pos());
+            is_clicked = MouseL.down();
+          } else {
+            return;
+          }
+
+          const flecs::entity hit = Pick(world, picking, ray);
+          UpdateHovered(picking, hit);
+
+          if (is_clicked && hit) {
+            // 前の選択からSelectingTagCDを外して、ヒットした対象に付ける
+            world.get_ref<SelectionSingletonCD>().get()->Select(hit);
+          }
+        });
+  }
+
+  private:
+  static void RebuildBvh(const flecs::query<const PickableCD, const PositionCD>&
+                           bvh_query,
+                         PickingSingletonCD& picking) {
+    std::vector<SphereBvh::Item> items;
+    items.reserve(static_cast<size_t>(bvh_query.count()));
+    bvh_query.each([&items](flecs::entity e, const PickableCD& pickable,
+                            const PositionCD& pos) {
+      items.push_back({e.id(), Sphere{pos.pos, pickable.radius}});
+    });
+    picking.bvh.Build(std::move(items));
+    picking.is_bvh_dirty = false;
+  }
+
+  // レイと最初に交差する選択対象を返す（無ければ無効なエンティティ）
+  static flecs::entity Pick(flecs::world& world, PickingSingletonCD& picking,
+                            const Ray& ray) {
+    flecs::entity hit;
+    float hit_distance = picking.max_distance;
+
+    if (const auto* px = world.try_get<PxDataSingletonCD>()) {
+      if (const auto px_hit = px->Raycast(ray, hit_distance)) {
+        // PickableCDを持たないActorに当たった場合も、それより奥の対象は選ばない
+        hit_distance = px_hit->distance;
+        if (px_hit->entity.is_alive() && px_hit->entity.has<PickableCD>()) {
+          hit = px_hit->entity;
+        }
+      }
+    }
+
+    if (const auto bvh_hit = picking.bvh.Raycast(ray, hit_distance)) {
+      const flecs::entity entity(world, bvh_hit->id);
+      if (entity.is_alive()) {
+        hit = entity;
+        hit_distance = bvh_hit->distance;
+      }
+    }
+
+    picking.hit_distance = hit ? hit_distance : 0.0f;
+    return hit;
+  }
+
+  // HoveringTagCDを前フレームの対象から外し、新しい対象に付ける
+  static void UpdateHovered(PickingSingletonCD& picking, flecs::entity hit) {
+    if (picking.hovered == hit) {
+      return;
+    }
+    if (picking.hovered && picking.hovered.is_alive()) {
+      picking.hovered.remove<HoveringTagCD>();
+    }
+    if (hit) {
+      hit.add<HoveringTagCD>();
+    }
+    picking.hovered = hit;
+  }
+};
@@ -5,29 +5,19 @@
 #include "CD/PositionCD.h"
 #include "CD/RotationCD.h"
 #include "CD/TextureCD.h"
+#include "System/InstancedRenderingSystem.h"
+#include "System/TextUISystem.h"
+#include "System/TransformSystem.h"
 #include "flecs/flecs.h"
 
 class RenderingSystem {
   public:
   static void Register(flecs::world& world) {
-    auto color_mesh_draw_sys =
-      world.system<PositionCD, RotationCD, MeshCD, ColorCD>("mesh_draw_sys")
-        .kind(flecs::PreStore)
-        .without(flecs::Prefab)
-        .each(
-          [](PositionCD& pos, RotationCD& rot, MeshCD& mesh, ColorCD& color) {
-            mesh.mesh.draw(pos.pos, rot.rot, color.c);
-          });
+    // 描画より先に親子関係の姿勢を確定させる（同じフェーズ内では登録順に実行される）
+    TransformSystem::Register(world);
 
-    auto tex_mesh_draw_sys =
-      world
-        .system<PositionCD, RotationCD, MeshCD, TextureCD>("tex_mesh_draw_sys")
-        .kind(flecs::PreStore)
-        .without(flecs::Prefab)
-        .each(
-          [](PositionCD& pos, RotationCD& rot, MeshCD& mesh, TextureCD& tex) {
-            mesh.mesh.draw(pos.pos, rot.rot, tex.tex);
-          });
+    // メッシュは同じメッシュ・テクスチャごとにまとめてインスタンス描画する
+    InstancedRenderingSystem::Register(world);
 
     auto model_draw_sys =
       world.system<PositionCD, RotationCD, ModelCD>("model_draw_sys")
@@ -36,5 +26,8 @@ class RenderingSystem {
         .each([](PositionCD& pos, RotationCD& rot, ModelCD& model) {
           model.model.draw(pos.pos, rot.rot);
         });
+
+    // テキストUIは3D描画の後（PostFrame）にフォントごとにまとめて描画する
+    TextUISystem::Register(world);
   }
 };
@@ -5,30 +5,24 @@
 #include "FrameWork/CD/HoveringTagCD.h"
 #include "FrameWork/CD/SelectableCD.h"
 #include "FrameWork/CD/SelectingTagCD.h"
+#include "FrameWork/SingletonCD/SelectionSingletonCD.h"
+#include "FrameWork/System/HoverSystem.h"
 #include "FrameWork/flecs/flecs.h"
 
 class SelectSystem {
   public:
   static void Register(flecs::world& world) {
-    world.system<SelectableCD>("select_sys")
-      .each([&world](flecs::entity e, SelectableCD& selectable) {
-        // マウス左クリックされたらSelectingTagCDを追加
-        if (selectable.area.leftClicked()) {
-          // 他のentityからSelectingTagCDを削除する
-          flecs::query<> query =
-            world.query_builder().with<SelectingTagCD>().build();
+    // ホバー判定の結果を使うため、HoverSystem（空間索引）を用意しておく
+    HoverSystem::Register(world);
 
-          query.each([e, &world](flecs::entity other) {
-            if (other != e) {
-              world.defer([other]() { other.remove<SelectingTagCD>(); });
-            }
-          });
-
-          // 自分にSelectingTagCDを追加
-          if (!e.has<SelectingTagCD>()) {
-            world.defer([e]() { e.add<SelectingTagCD>(); });
-          }
+    // マウス左クリックされたら、ホバー中のentityを選択する
+    // 選択はSelectionSingletonCDで1つだけ保持しているので、他のentityを探す必要はない
+    world.system<SelectionSingletonCD>("select_sys")
+      .each([](SelectionSingletonCD& selection) {
+        if (MouseL.down() && selection.hovered &&
+            selection.hovered.is_alive()) {
+          selection.Select(selection.hovered);
         }
       });
   }
-};
\ No newline at end of file
+};
@@ -1,61 +1,133 @@
 ﻿#pragma once
 #include <Siv3D.hpp>
 
+#include "CD/AnimationScheduleCD.h"
+#include "CD/AtlasFrameArrayCD.h"
 #include "CD/FrameCD.h"
 #include "CD/SpriteAnimationCD.h"
+#include "CD/SpriteRegionCD.h"
 #include "CD/TextureArrayCD.h"
 #include "CD/TextureCD.h"
-#include "CD/TimerCD.h"
+#include "SingletonCD/SpriteAnimationSingletonCD.h"
 #include "flecs/flecs.h"
 
+// スプライトアニメーションのフレームを切り替えるシステム
+// 各エンティティの次の切り替え時刻をタイマーホイールに登録し、時刻を迎えたエンティティだけを処理する
+// 1フレームのコストはアニメーション中のエンティティ数ではなく、フレームが切り替わった数に比例する
+// 切り替えたエンティティだけFrameCDとTextureCD/SpriteRegionCDをmodified()するので、
+// 下流のシステムはflecsの変更検出（changed()）で変化のあったものだけを扱える
 class SpriteAnimationSystem {
   public:
   static void Register(flecs::world& world) {
-    // フレーム更新システム: SpriteAnimationCD, TimerCD, TextureArrayCD,
-    // FrameCDを持つエンティティを処理
-    auto frame_update_sys =
-      world
-        .system<SpriteAnimationCD, TimerCD, TextureArrayCD, FrameCD>(
-          "frame_update_sys")
+    world.add<SpriteAnimationSingletonCD>();
+
+    // SpriteAnimationCDが設定されたら最初の切り替えを登録する（再設定された場合は登録し直す）
+    world.observer<const SpriteAnimationCD>("sprite_anim_schedule_obs")
+      .event(flecs::OnSet)
+      .each([](flecs::entity e, const SpriteAnimationCD& anim) {
+        SpriteAnimationSingletonCD& scheduler =
+          *e.world().get_ref<SpriteAnimationSingletonCD>().get();
+        const uint64 due_tick = scheduler.wheel.ScheduleAfter(
+          e.id(), scheduler.wheel.ToTicks(anim.interval));
+        e.set<AnimationScheduleCD>({due_tick});
+      });
+
+    // 時刻を進め、切り替え時刻を迎えたエンティティのフレームを進める
+    auto sprite_anim_sys =
+      world.system<SpriteAnimationSingletonCD>("sprite_anim_sys")
         .kind(flecs::PreUpdate)
-        .without(flecs::Prefab)
-        .each([](SpriteAnimationCD& anim, TimerCD& timer,
-                 TextureArrayCD& textureArray, FrameCD& frame) {
-          // タイマーが間隔を超えた場合、フレームを進める
-          if (timer.current_timer >= anim.interval) {
-            // タイマーをリセット
-            timer.current_timer = 0.0;
-
-            // フレームを進める
-            frame.frame++;
-
-            // テクスチャ配列のサイズを超えた場合、ループ処理
-            if (frame.frame >= static_cast<int>(textureArray.textures.size())) {
-              if (anim.loop) {
-                frame.frame = 0;  // ループする場合は0に戻す
-              } else {
-                frame.frame = static_cast<int>(textureArray.textures.size()) -
-                              1;  // ループしない場合は最後のフレームで停止
-              }
-            }
-          }
+        .each([](flecs::iter& it, size_t,
+                 SpriteAnimationSingletonCD& scheduler) {
+          flecs::world world = it.world();
+          scheduler.time += it.delta_time();
+          scheduler.wheel.Advance(
+            scheduler.time, [&world, &scheduler](uint64 id, uint64 due_tick) {
+              OnFrameDue(world, scheduler, id, due_tick);
+            });
         });
+  }
 
-    // テクスチャ更新システム: TextureArrayCD, TextureCD, SpriteAnimationCD,
-    // FrameCDを持つエンティティを処理
-    auto texture_update_sys =
-      world.system<TextureArrayCD, TextureCD, FrameCD>("texture_update_sys")
-        .kind(flecs::PreUpdate)
-        .without(flecs::Prefab)
-        .with<SpriteAnimationCD>()
-        .each(
-          [](TextureArrayCD& textureArray, TextureCD& texture, FrameCD& frame) {
-            // フレーム番号が有効な範囲内かチェック
-            if (frame.frame >= 0 &&
-                frame.frame < static_cast<int>(textureArray.textures.size())) {
-              // TextureArrayCDの指定されたフレームのテクスチャをTextureCDに設定
-              texture.tex = textureArray.textures[frame.frame];
-            }
-          });
+  private:
+  static void OnFrameDue(flecs::world& world,
+                         SpriteAnimationSingletonCD& scheduler, uint64 id,
+                         uint64 due_tick) {
+    const flecs::entity e(world, id);
+    if (!e.is_alive()) {
+      return;
+    }
+    auto* schedule = e.try_get_mut<AnimationScheduleCD>();
+    const auto* anim = e.try_get<SpriteAnimationCD>();
+    auto* frame = e.try_get_mut<FrameCD>();
+    // SpriteAnimationCDの再設定などで登録し直された古い通知は無視する
+    if (!schedule || !anim || !frame || schedule->due_tick != due_tick) {
+      return;
+    }
+
+    const int frame_count = GetFrameCount(e);
+    if (frame_count <= 0) {
+      schedule->due_tick = 0;
+      return;
+    }
+
+    const int next = GetNextFrame(*anim, frame->frame, frame_count);
+    if (next != frame->frame) {
+      frame->frame = next;
+      e.modified<FrameCD>();
+      ApplyFrame(e, next);
+    }
+
+    // ループしない場合は最後のフレームで止め、以降は登録しない
+    if (!anim->loop && next >= frame_count - 1) {
+      schedule->due_tick = 0;
+      return;
+    }
+    // 処理が遅れても間隔がずれないよう、今回の予定時刻を基準に次を登録する
+    schedule->due_tick = scheduler.wheel.ScheduleAt(
+      id, due_tick + scheduler.wheel.ToTicks(anim->interval));
+  }
+
+  static int GetFrameCount(const flecs::entity& e) {
+    if (const auto* frames = e.try_get<AtlasFrameArrayCD>()) {
+      return static_cast<int>(frames->frames.size());
+    }
+    if (const auto* textures = e.try_get<TextureArrayCD>()) {
+      return static_cast<int>(textures->textures.size());
+    }
+    return 0;
+  }
+
+  static int GetNextFrame(const SpriteAnimationCD& anim, int frame,
+                          int frame_count) {
+    const int next = frame + 1;
+    if (next < frame_count) {
+      return next;
+    }
+    // ループする場合は0に戻し、しない場合は最後のフレームで停止
+    return anim.loop ? 0 : frame_count - 1;
+  }
+
+  // アトラスの場合は領域を、テクスチャ配列の場合はテクスチャを差し替える
+  static void ApplyFrame(const flecs::entity& e, int frame) {
+    if (const auto* frames = e.try_get<AtlasFrameArrayCD>()) {
+      if (auto* sprite = e.try_get_mut<SpriteRegionCD>()) {
+        const auto& current = frames->frames[frame];
+        if (sprite->atlas.id() != current.atlas.id()) {
+          sprite->atlas = current.atlas;
+        }
+        sprite->region = current.region;
+        e.modified<SpriteRegionCD>();
+      }
+      return;
+    }
+    if (const auto* textures = e.try_get<TextureArrayCD>()) {
+      if (auto* texture = e.try_get_mut<TextureCD>()) {
+        const Texture& next = textures->textures[frame];
+        // 同じテクスチャなら書き込まず、変更としても通知しない
+        if (texture->tex.id() != next.id()) {
+          texture->tex = next;
+          e.modified<TextureCD>();
+        }
+      }
+    }
   }
 };
@@ -5,12 +5,22 @@
 #include "CD/Rotation2DCD.h"
 #include "CD/ScalarScaleCD.h"
 #include "CD/Size2DCD.h"
+#include "CD/SpriteRegionCD.h"
 #include "CD/TextureCD.h"
+#include "SingletonCD/SpriteAtlasSingletonCD.h"
 #include "flecs/flecs.h"
 
 class SpriteRenderingSystem {
   public:
   static void Register(flecs::world& world) {
+    // 詰め込んだアトラスのページを、スプライトの描画より先にGPUへ転送する
+    auto atlas_upload_sys =
+      world.system<SpriteAtlasSingletonCD>("atlas_upload_sys")
+        .kind(flecs::PostFrame)
+        .each([](SpriteAtlasSingletonCD& sprite_atlas) {
+          sprite_atlas.atlas.Upload();
+        });
+
     // Size2DCDを使用するスプライト描画システム
     auto sprite_size_draw_sys =
       world
@@ -30,6 +40,22 @@ class SpriteRenderingSystem {
           texture.tex.resized(size.size).rotated(rotation).drawAt(draw_pos);
         });
 
+    // アトラス上のスプライト（SpriteRegionCD）もTextureCDのときと同じ順番で描画する
+    // 同じページの領域は同じテクスチャなので、連続した描画は2D描画側で1回のドローコールにまとめられる
+    auto atlas_sprite_size_draw_sys =
+      world
+        .system<const PositionCD, const Rotation2DCD, const Size2DCD,
+                const SpriteRegionCD>("atlas_sprite_size_draw_sys")
+        .kind(flecs::PostFrame)
+        .without(flecs::Prefab)
+        .each([](const PositionCD& pos, const Rotation2DCD& rot,
+                 const Size2DCD& size, const SpriteRegionCD& sprite) {
+          sprite.atlas(sprite.region)
+            .resized(size.size)
+            .rotated(rot.rotation)
+            .drawAt(pos.pos.xy());
+        });
+
     // ScalarScaleCDを使用するスプライト描画システム
     auto sprite_draw_sys =
       world
@@ -48,5 +74,19 @@ class SpriteRenderingSystem {
           // Texture.drawに直接パラメータを渡して描画
           texture.tex.scaled(scale.scale).rotated(rotation).drawAt(draw_pos);
         });
+
+    auto atlas_sprite_draw_sys =
+      world
+        .system<const PositionCD, const Rotation2DCD, const ScalarScaleCD,
+                const SpriteRegionCD>("atlas_sprite_draw_sys")
+        .kind(flecs::PostFrame)
+        .without(flecs::Prefab)
+        .each([](const PositionCD& pos, const Rotation2DCD& rot,
+                 const ScalarScaleCD& scale, const SpriteRegionCD& sprite) {
+          sprite.atlas(sprite.region)
+            .scaled(scale.scale)
+            .rotated(rot.rotation)
+            .drawAt(pos.pos.xy());
+        });
   }
 };
@@ -6,29 +6,127 @@
 #include "CD/PositionCD.h"
 #include "CD/ScalarScaleCD.h"
 #include "CD/TextCD.h"
+#include "CD/TextLayoutCD.h"
 #include "SharedCD/FontSharedCD.h"
+#include "SingletonCD/TextLayoutSingletonCD.h"
 #include "flecs/flecs.h"
 
+// テキストUIの描画システム
+// グリフの配置はTextCD・ScalarScaleCD（フォントサイズ）・フォントが変わったときだけTextLayoutCDに計算し、
+// 毎フレームはキャッシュした矩形を描画するだけにする
+// フォント（IsAで継承したFontSharedCD）ごとにまとめて描画するため、同じフォントのテキストは
+// 同じアトラスへの連続した描画になり、1回のドローコールにまとめられる
+// RenderingSystem::Register()から登録されるため、テキストを描画するワールドではそちらを登録すること
 class TextUISystem {
   public:
-  static void Register(flecs::world& world,
-                       const std::vector<flecs::entity>& font_entities) {
-    for (size_t i = 0; i < font_entities.size(); ++i) {
-      const auto& font_entity = font_entities[i];
-      String system_name = U"text_draw_sys_" + ToString(i);
-
-      auto text_draw_sys =
-        world
-          .system<PositionCD, ScalarScaleCD, TextCD, ColorCD>(
-            system_name.narrow().c_str())
-          .with(flecs::IsA, font_entity)
-          .kind(flecs::PostFrame)
-          .without(flecs::Prefab)
-          .each([font_entity](PositionCD& pos, ScalarScaleCD& scale,
-                              TextCD& text, ColorCD& color) {
-            const auto& font = font_entity.get<FontSharedCD>().font;
-            font(text.text).draw(scale.scale, pos.pos.xy(), color.c);
-          });
+  static void Register(flecs::world& world) {
+    world.add<TextLayoutSingletonCD>();
+
+    // 変更検出: テキスト・サイズ・フォントのどれかが設定されたらレイアウトを作り直す
+    // FontSharedCDはフォントエンティティから継承しているため、フォントの再設定も通知される
+    world
+      .observer<const TextCD, const ScalarScaleCD, const FontSharedCD>(
+        "text_layout_dirty_obs")
+      .event(flecs::OnSet)
+      .each([](flecs::entity e, const TextCD&, const ScalarScaleCD&,
+               const FontSharedCD&) {
+        e.world().get_ref<TextLayoutSingletonCD>().get()->dirty.push_back(e);
+      });
+
+    // TextLayoutCDを持たないテキストに追加する（追加時にレイアウトも作る）
+    // 追加は遅延操作になるため、write()で宣言してパイプラインに後続の描画より前でマージさせる
+    auto text_layout_add_sys =
+      world.system<const TextCD>("text_layout_add_sys")
+        .with<ScalarScaleCD>()
+        .with<FontSharedCD>()
+        .without<TextLayoutCD>()
+        .write<TextLayoutCD>()
+        .kind(flecs::OnStore)
+        .without(flecs::Prefab)
+        .each([](flecs::entity e, const TextCD&) {
+          e.add<TextLayoutCD>();
+          e.world().get_ref<TextLayoutSingletonCD>().get()->dirty.push_back(e);
+        });
+
+    // 変更のあったテキストだけレイアウトを作り直す
+    auto text_layout_sys =
+      world.system<TextLayoutSingletonCD>("text_layout_sys")
+        .kind(flecs::PostFrame)
+        .each([](TextLayoutSingletonCD& layouts) {
+          for (const auto& e : layouts.dirty) {
+            if (e.is_alive()) {
+              Layout(e);
+            }
+          }
+          layouts.dirty.clear();
+        });
+
+    // テーブル（＝継承しているフォント）ごとにまとめて描画する
+    auto text_draw_sys =
+      world
+        .system<const PositionCD, const ColorCD, const TextLayoutCD,
+                const FontSharedCD>("text_draw_sys")
+        .kind(flecs::PostFrame)
+        .without(flecs::Prefab)
+        .run([](flecs::iter& it) {
+          while (it.next()) {
+            auto pos = it.field<const PositionCD>(0);
+            auto color = it.field<const ColorCD>(1);
+            auto layout = it.field<const TextLayoutCD>(2);
+            auto font = it.field<const FontSharedCD>(3);
+
+            const auto draw_row = [&](size_t i) {
+              const Vec2 origin = pos[i].pos.xy();
+              for (const auto& quad : layout[i].quads) {
+                quad.region.draw(origin + quad.offset, color[i].c);
+              }
+            };
+
+            // 自身がFontSharedCDを持つテキストは行ごとにフォントが異なる
+            if (it.is_self(3)) {
+              for (auto i : it) {
+                const ScopedCustomShader2D shader{
+                  Font::GetPixelShader(font[i].font.method())};
+                draw_row(i);
+              }
+              continue;
+            }
+
+            // 継承したフォントはテーブル内で共通
+            const ScopedCustomShader2D shader{
+              Font::GetPixelShader(font[0].font.method())};
+            for (auto i : it) {
+              draw_row(i);
+            }
+          }
+        });
+  }
+
+  private:
+  // グリフを配置してTextLayoutCDに保存する（ScalarScaleCDはフォントサイズとして扱う）
+  static void Layout(flecs::entity e) {
+    const auto* text = e.try_get<TextCD>();
+    const auto* size = e.try_get<ScalarScaleCD>();
+    const auto* font_cd = e.try_get<FontSharedCD>();
+    auto* layout = e.try_get_mut<TextLayoutCD>();
+    if (!text || !size || !font_cd || !layout || !font_cd->font) {
+      return;
+    }
+
+    const Font& font = font_cd->font;
+    const double scale = size->scale / font.fontSize();
+    layout->quads.clear();
+
+    Vec2 pen_pos{0, 0};
+    for (const auto& glyph : font.getGlyphs(text->text)) {
+      if (glyph.codePoint == U'\n') {
+        pen_pos.x = 0;
+        pen_pos.y += (font.height() * scale);
+        continue;
+      }
+      layout->quads.push_back(
+        {glyph.texture.scaled(scale), pen_pos + glyph.getOffset(scale)});
+      pen_pos.x += (glyph.xAdvance * scale);
     }
   }
 };
@@ -7,12 +7,15 @@
 class TimerSystem {
   public:
   static void Register(flecs::world& world) {
+    // エンティティごとに独立したデータ変換なのでワーカースレッドで分割実行する
     auto timer_sys = world.system<TimerCD>("timer_sys")
                        .kind(flecs::PreUpdate)
                        .without(flecs::Prefab)
-                       .each([](TimerCD& timer) {
+                       .multi_threaded()
+                       .each([](flecs::iter& it, size_t, TimerCD& timer) {
                          // デルタタイムを加算してタイマーを更新
-                         timer.current_timer += Scene::DeltaTime();
+                         // ワーカースレッドからSiv3Dの関数は呼ばず、progress()に渡された値を使う
+                         timer.current_timer += it.delta_time();
                        });
   }
 };
@@ -0,0 +1,71 @@
+﻿#pragma once
+#include "CD/LocalTransformCD.h"
+#include "CD/PositionCD.h"
+#include "CD/RotationCD.h"
+#include "flecs/flecs.h"
+
+// flecs::ChildOfの親子関係に沿って、LocalTransformCDから子のPositionCD/RotationCDを求める
+// 親を動かすだけで子孫が追従するため、ゲーム側で移動量を子へ配る必要はない
+//   EntityFactory::AttachChild(bolt, parts, Vec3{0, 10, 0});
+// PositionCD/RotationCDは常にワールド座標のままなので、描画・ピッキング側の変更は不要
+// 物理ボディ（DynamicBodyCD）を持つエンティティを子にしないこと（姿勢を奪い合う）
+class TransformSystem {
+  public:
+  // RenderingSystemからも呼ばれるため、2回目以降の呼び出しでは何もしない
+  static void Register(flecs::world& world) {
+    if (world.lookup("transform_hierarchy_sys")) {
+      return;
+    }
+
+    // cascadeで親の階層が浅いテーブルから順に処理するため、
+    // 1回の走査で親の最新の姿勢を使って孫以下まで確定する
+    // 変更検出（detect_changes）で、親の姿勢もローカル姿勢も変わっていないテーブルは丸ごと飛ばす
+    // 飛ばしたテーブルは自身のPositionCD/RotationCDが更新済みにならないため、その子孫のテーブルも同様に飛ばされる
+    // 自身のPositionCD/RotationCDはout()で書き込み専用にし、ここでの書き込みを変更として数えない
+    // 物理の反映（PostUpdate）より後、描画（PreStore）より前に実行する
+    auto transform_hierarchy_sys =
+      world
+        .system<PositionCD, RotationCD, const LocalTransformCD,
+                const PositionCD, const RotationCD>("transform_hierarchy_sys")
+        .term_at(0)
+        .out()
+        .term_at(1)
+        .out()
+        .term_at(3)
+        .cascade()
+        .term_at(4)
+        .cascade()
+        .kind(flecs::PreStore)
+        .without(flecs::Prefab)
+        .detect_changes()
+        .run([](flecs::iter& it) {
+          while (it.next()) {
+            if (!it.changed()) {
+              it.skip();
+              continue;
+            }
+
+            auto pos = it.field<PositionCD>(0);
+            auto rot = it.field<RotationCD>(1);
+            auto local = it.field<const LocalTransformCD>(2);
+            auto parent_pos = it.field<const PositionCD>(3);
+            auto parent_rot = it.field<const RotationCD>(4);
+
+            // 同じ親の子は同じテーブルに並ぶため、親の姿勢はテーブル内で共通
+            for (auto i : it) {
+              Compose(local[i], parent_pos[0].pos, parent_rot[0].rot, pos[i],
+                      rot[i]);
+            }
+          }
+        });
+  }
+
+  private:
+  // ローカル姿勢を回転させてから親の姿勢を適用する
+  static void Compose(const LocalTransformCD& local, const Vec3& parent_pos,
+                      const Quaternion& parent_rot, PositionCD& pos,
+                      RotationCD& rot) {
+    pos.pos = parent_pos + parent_rot * local.pos;
+    rot.rot = local.rot * parent_rot;
+  }
+};
@@ -36,6 +36,16 @@ class ChatMessageItem {
     m_rect = CalculateTextRect(m_pos, m_text, m_style, m_width, m_alignment);
   }
 
+  // テキストを差し替えるsetter（ストリーミング表示用）
+  // このアイテムの矩形のみ再計算する
+  void SetText(const s3d::String& text) {
+    m_text = text;
+    m_rect = CalculateTextRect(m_pos, m_text, m_style, m_width, m_alignment);
+  }
+
+  // テキストを取得するgetter
+  const s3d::String& GetText() const { return m_text; }
+
   static s3d::RectF CalculateTextRect(s3d::Vec2 pos, const s3d::String& text,
                                       const MessageAreaStyle& style,
                                       double width, Alignment alignment) {
@@ -78,6 +78,52 @@ class ChatMessageWindow {
     m_messages.emplace_back(info);
   }
 
+  // ストリーミング表示するメッセージを開始する
+  // テキストが届くまではアイテムを作らず、最初の文字が届いた時点で表示する
+  void BeginStreamingMessage(Sender sender) {
+    m_is_streaming = true;
+    m_has_streaming_item = false;
+    m_streaming_sender = sender;
+  }
+
+  // ストリーミング中のメッセージのテキストを更新する
+  // 伸びたアイテムのみ再レイアウトし、はみ出た場合だけ古いメッセージを削除する
+  void UpdateStreamingMessage(const s3d::String& text) {
+    if (!m_is_streaming || text.isEmpty()) {
+      return;
+    }
+
+    if (!m_has_streaming_item) {
+      AddMessage(text, m_streaming_sender);
+      m_has_streaming_item = true;
+      return;
+    }
+
+    m_messages.back().item.SetText(text);
+
+    // メッセージがウィンドウからはみ出る場合、古いメッセージを削除
+    while (m_messages.size() > 1 &&
+           !GetRect().contains(m_messages.back().item.GetRect())) {
+      m_messages.erase(m_messages.begin());
+      UpdateMessagePositions();
+    }
+  }
+
+  // ストリーミング表示を終了し、最終テキストで確定する
+  void EndStreamingMessage(const s3d::String& text) {
+    if (!m_is_streaming) {
+      AddMessage(text, m_streaming_sender);
+      return;
+    }
+
+    UpdateStreamingMessage(text);
+    m_is_streaming = false;
+    m_has_streaming_item = false;
+  }
+
+  // ストリーミング表示中かどうか
+  bool IsStreaming() const { return m_is_streaming; }
+
   void Draw() const {
     // ウィンドウの背景を角丸で描画
     m_desc.rect.rounded(kWindowCornerRadius).draw(m_desc.background_color);
@@ -94,6 +140,8 @@ class ChatMessageWindow {
   // すべてのメッセージをクリアする
   void Clear() {
     m_messages.clear();
+    m_is_streaming = false;
+    m_has_streaming_item = false;
   }
 
   private:
@@ -165,4 +213,9 @@ class ChatMessageWindow {
 
   std::vector<ChatMessageInfo> m_messages;
   ChatMessageWindowDesc m_desc;  // ウィンドウの設定情報
+
+  // ストリーミング表示の状態
+  bool m_is_streaming = false;                // ストリーミング表示中か
+  bool m_has_streaming_item = false;          // ストリーミング用アイテムを追加済みか（末尾のアイテム）
+  Sender m_streaming_sender = Sender::Partner;  // ストリーミング中のメッセージの送信者
 };
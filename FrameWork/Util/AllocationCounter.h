@@ -0,0 +1,60 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+#include <cstdlib>
+#include <new>
+
+// スレッドごとのヒープ確保回数とバイト数を数えるカウンター
+// グローバルなoperator new / deleteの置き換えから呼ばれる（置き換えはMain.cppで1度だけ定義する）
+// 置き換えは計測用のビルドでENABLE_ALLOCATION_COUNTERを定義したときだけ有効になる（配布するexeには含めない）
+//   void* operator new(std::size_t size) { return AllocationCounter::Allocate(size); }
+//   void operator delete(void* p) noexcept { AllocationCounter::Free(p); }
+// 区間の確保量は前後のスナップショットの差で求める
+//   const auto before = AllocationCounter::GetThreadSnapshot();
+//   ...;
+//   const auto allocated = AllocationCounter::GetThreadSnapshot() - before;
+// 数えるのは呼び出したスレッドの確保のみ（ワーカースレッドやDLL内の確保は含まない）
+class AllocationCounter {
+  public:
+  AllocationCounter() = delete;
+
+#ifdef ENABLE_ALLOCATION_COUNTER
+  static constexpr bool kIsEnabled = true;
+#else
+  // 無効なビルドでは常に0が返る
+  static constexpr bool kIsEnabled = false;
+#endif
+
+  struct Snapshot {
+    uint64 count = 0;  // 確保回数
+    uint64 bytes = 0;  // 確保したバイト数（解放分は差し引かない）
+
+    [[nodiscard]] Snapshot operator-(const Snapshot& other) const noexcept {
+      return Snapshot{count - other.count, bytes - other.bytes};
+    }
+  };
+
+  // 呼び出したスレッドのこれまでの累計を取得する
+  [[nodiscard]] static Snapshot GetThreadSnapshot() noexcept {
+    return Snapshot{s_count, s_bytes};
+  }
+
+  // operator newの置き換えから呼ぶ
+  [[nodiscard]] static void* Allocate(std::size_t size) {
+    ++s_count;
+    s_bytes += size;
+    // 0バイトの要求にも一意なポインタを返す必要がある
+    if (void* p = std::malloc(size ? size : 1)) {
+      return p;
+    }
+    throw std::bad_alloc{};
+  }
+
+  // operator deleteの置き換えから呼ぶ
+  static void Free(void* p) noexcept {
+    std::free(p);
+  }
+
+  private:
+  static inline thread_local uint64 s_count = 0;
+  static inline thread_local uint64 s_bytes = 0;
+};
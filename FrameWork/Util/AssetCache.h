@@ -0,0 +1,84 @@
+﻿// AssetCache.h
+#pragma once
+#include <Siv3D.hpp>
+#include <array>
+#include <functional>
+
+// テクスチャとプロシージャルメッシュをプロセス全体で共有するユーティリティクラス
+// EntityFactoryとゲーム側（作業フェーズなど）の両方がこのキャッシュを使う
+// Texture/Meshはハンドルなのでコピーしても同じGPUリソースを指す。2回目以降の取得ではファイル読み込みもGPU転送も行わない
+// フェーズの生成時にPrewarm系の関数を呼んでおけば、ゲーム中の生成処理はキャッシュを引くだけになる
+class AssetCache {
+  public:
+  AssetCache() = delete;
+  ~AssetCache() = delete;
+
+  // パスとテクスチャの設定ごとに共有するテクスチャ（読み込みに失敗した場合は空のテクスチャをキャッシュする）
+  [[nodiscard]] static Texture GetTexture(FilePathView path,
+                                          TextureDesc desc = TextureDesc::Unmipped) {
+    TextureKey key{FilePath{path}, desc};
+    if (auto it = textures_.find(key); it != textures_.end()) {
+      return it->second;
+    }
+    Texture texture{key.path, desc};
+#ifdef _DEBUG
+    if (!texture) {
+      s3d::Console << U"AssetCache: テクスチャ '" << key.path << U"' の読み込みに失敗しました。";
+    }
+#endif
+    textures_.emplace(std::move(key), texture);
+    return texture;
+  }
+
+  // 形状パラメータごとに共有する円柱メッシュ（原点中心）
+  [[nodiscard]] static Mesh GetCylinderMesh(double radius, double height, uint32 quality) {
+    const std::array<double, 3> params{radius, height, static_cast<double>(quality)};
+    const uint64 key = Hash::FNV1a(params);
+    if (auto it = cylinderMeshes_.find(key); it != cylinderMeshes_.end()) {
+      return it->second;
+    }
+    Mesh mesh{MeshData::Cylinder({0, 0, 0}, radius, height, quality)};
+    cylinderMeshes_.emplace(key, mesh);
+    return mesh;
+  }
+
+  // サイズごとに共有する直方体メッシュ（原点中心）
+  [[nodiscard]] static Mesh GetBoxMesh(const Vec3& size) {
+    if (auto it = boxMeshes_.find(size); it != boxMeshes_.end()) {
+      return it->second;
+    }
+    Mesh mesh{MeshData::Box(size)};
+    boxMeshes_.emplace(size, mesh);
+    return mesh;
+  }
+
+  // 半径ごとに共有する球メッシュ（原点中心）
+  [[nodiscard]] static Mesh GetSphereMesh(float radius) {
+    if (auto it = sphereMeshes_.find(radius); it != sphereMeshes_.end()) {
+      return it->second;
+    }
+    Mesh mesh{MeshData::Sphere(radius)};
+    sphereMeshes_.emplace(radius, mesh);
+    return mesh;
+  }
+
+  private:
+  // 同じファイルでもミップマップやsRGBの設定が違えば別のテクスチャになる
+  struct TextureKey {
+    FilePath path;
+    TextureDesc desc;
+
+    bool operator==(const TextureKey&) const = default;
+  };
+  struct TextureKeyHash {
+    size_t operator()(const TextureKey& key) const noexcept {
+      return std::hash<FilePath>{}(key.path) ^ (static_cast<size_t>(key.desc) * 0x9E3779B97F4A7C15ull);
+    }
+  };
+
+  // データメンバ（モノステートパターンのため静的）
+  static inline HashTable<TextureKey, Texture, TextureKeyHash> textures_;  // パスと設定をキーとしたテクスチャ
+  static inline HashTable<uint64, Mesh> cylinderMeshes_;  // 形状パラメータのハッシュをキーとした円柱メッシュ
+  static inline HashTable<Vec3, Mesh> boxMeshes_;         // サイズをキーとした直方体メッシュ
+  static inline HashTable<float, Mesh> sphereMeshes_;     // 半径をキーとした球メッシュ
+};
@@ -0,0 +1,99 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+#include <limits>
+
+// 円の集合に対する一様グリッドの空間索引
+// 2DのSelectableCD::areaを登録しておき、点を含む円を点のあるセルの中だけから探す
+// 円の追加・移動・削除はそのIDが入っているセルだけを更新する
+class CircleGrid {
+  public:
+  explicit CircleGrid(double cell_size = 64.0) : m_cell_size(cell_size) {}
+
+  // 登録または移動（同じIDは置き換える）
+  void Set(uint64 id, const Circle& circle) {
+    Remove(id);
+    Item& item = m_items[id];
+    item.circle = circle;
+
+    const RectF bounds = circle.boundingRect();
+    const Point min_cell = ToCell(bounds.tl());
+    const Point max_cell = ToCell(bounds.br());
+    for (int32 y = min_cell.y; y <= max_cell.y; ++y) {
+      for (int32 x = min_cell.x; x <= max_cell.x; ++x) {
+        const uint64 key = ToKey(Point{x, y});
+        m_cells[key] << id;
+        item.cells << key;
+      }
+    }
+  }
+
+  void Remove(uint64 id) {
+    const auto it = m_items.find(id);
+    if (it == m_items.end()) {
+      return;
+    }
+    for (const uint64 key : it->second.cells) {
+      const auto cell = m_cells.find(key);
+      if (cell == m_cells.end()) {
+        continue;
+      }
+      // セル内の要素は少数なので線形に探して末尾と入れ替える
+      Array<uint64>& ids = cell->second;
+      for (size_t i = 0; i < ids.size(); ++i) {
+        if (ids[i] == id) {
+          ids[i] = ids.back();
+          ids.pop_back();
+          break;
+        }
+      }
+      if (ids.isEmpty()) {
+        m_cells.erase(cell);
+      }
+    }
+    m_items.erase(it);
+  }
+
+  // 点を含む円のうち、中心が最も近いもののIDを返す
+  Optional<uint64> FindAt(const Vec2& point) const {
+    const auto cell = m_cells.find(ToKey(ToCell(point)));
+    if (cell == m_cells.end()) {
+      return none;
+    }
+    Optional<uint64> found;
+    double best = std::numeric_limits<double>::max();
+    for (const uint64 id : cell->second) {
+      const Circle& circle = m_items.at(id).circle;
+      if (!circle.intersects(point)) {
+        continue;
+      }
+      const double distance = circle.center.distanceFromSq(point);
+      if (distance < best) {
+        best = distance;
+        found = id;
+      }
+    }
+    return found;
+  }
+
+  size_t GetCount() const { return m_items.size(); }
+
+  private:
+  struct Item {
+    Circle circle;
+    Array<uint64> cells;  // 登録しているセルのキー
+  };
+
+  Point ToCell(const Vec2& pos) const {
+    return Point{static_cast<int32>(Math::Floor(pos.x / m_cell_size)),
+                 static_cast<int32>(Math::Floor(pos.y / m_cell_size))};
+  }
+
+  static uint64 ToKey(const Point& cell) {
+    return (static_cast<uint64>(static_cast<uint32>(cell.x)) << 32) |
+           static_cast<uint32>(cell.y);
+  }
+
+  double m_cell_size;
+  HashTable<uint64, Item> m_items;
+  HashTable<uint64, Array<uint64>> m_cells;
+};
@@ -0,0 +1,24 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+#include <thread>
+
+#include "flecs/flecs.h"
+
+// flecsのワーカースレッドに関するユーティリティを提供する構造体
+// multi_threaded()を指定したシステムはワーカースレッドにエンティティを分割して実行される
+// 指定していないシステム（Siv3Dの描画を呼ぶものなど）は常にメインスレッドで実行される
+struct EcsThreadUtil {
+  // コンストラクタを削除してインスタンス化を禁止
+  EcsThreadUtil() = delete;
+
+  // ワーカースレッド数を設定する（world.progress()より前に呼ぶ）
+  // 引数: threads - スレッド数。0以下なら論理コア数を使う
+  // 戻り値: 設定したスレッド数
+  static int32 EnableMultiThreading(flecs::world& world, int32 threads = 0) {
+    if (threads <= 0) {
+      threads = Max(1, static_cast<int32>(std::thread::hardware_concurrency()));
+    }
+    world.set_threads(threads);
+    return threads;
+  }
+};
@@ -2,6 +2,7 @@
 #include <Siv3D.hpp>
 
 #include "../SharedCD/FontSharedCD.h"
+#include "../SingletonCD/FontRegistrySingletonCD.h"
 #include "flecs/flecs.h"
 
 // フォント関連のユーティリティを提供する構造体
@@ -11,23 +12,80 @@ struct FontUtil {
 
   static constexpr StringView StandardFontName = U"StandardFont";
 
+  // フォント名からフォントIDを求める（FNV-1a）
+  // 定数の名前はコンパイル時に求めておけば、検索時に文字列を扱わずに済む
+  static constexpr uint64 ToFontId(s3d::StringView fontName) {
+    uint64 hash = 14695981039346656037ull;
+    for (const char32 ch : fontName) {
+      hash ^= static_cast<uint64>(ch);
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+
+  static constexpr uint64 StandardFontId = ToFontId(StandardFontName);
+
+  // フォント名の索引を作成し、FontSharedCDの設定・削除に合わせて更新するオブザーバーを登録する
+  // EntityFactory::Initialize()から呼ばれる
+  static void InitializeFontIndex(flecs::world& world) {
+    if (world.has<FontRegistrySingletonCD>()) {
+      return;
+    }
+    world.add<FontRegistrySingletonCD>();
+
+    world.observer<const FontSharedCD>("font_index_set_obs")
+      .event(flecs::OnSet)
+      .each([](flecs::entity e, const FontSharedCD& fontCD) {
+        FontRegistrySingletonCD& registry =
+          *e.world().get_ref<FontRegistrySingletonCD>().get();
+        // 名前が変わった場合は古いキーを消す
+        UnregisterFont(registry, e);
+        const uint64 fontId = ToFontId(fontCD.name);
+        const auto it = registry.fonts.find(fontId);
+        if (it != registry.fonts.end() && it->second.name != fontCD.name) {
+          // 名前の異なるフォントとIDが衝突した場合は先に登録した方を残す
+          Console << U"FontUtil: フォントIDが衝突しました: " << fontCD.name
+                  << U" / " << it->second.name;
+          return;
+        }
+        registry.fonts[fontId] = {fontCD.name, e};
+        registry.font_ids[e.id()] = fontId;
+      });
+
+    world.observer<const FontSharedCD>("font_index_remove_obs")
+      .event(flecs::OnRemove)
+      .each([](flecs::entity e, const FontSharedCD&) {
+        FontRegistrySingletonCD& registry =
+          *e.world().get_ref<FontRegistrySingletonCD>().get();
+        UnregisterFont(registry, e);
+      });
+  }
+
+  // 指定したIDと名前のフォントCDエンティティを返す
+  // 引数: fontId - ToFontId(fontName)の値（定数の名前ならコンパイル時に求めておける）
+  //       fontName - 検索するフォント名（索引のエントリの名前と照合する）
+  // 戻り値:
+  // 該当するフォントCDのflecs::entity。見つからない場合は無効なentityを返す
+  static flecs::entity FindFontCD(flecs::world& world, uint64 fontId,
+                                  s3d::StringView fontName) {
+    const auto* registry = world.try_get<FontRegistrySingletonCD>();
+    if (!registry) {
+      return flecs::entity();
+    }
+    const auto it = registry->fonts.find(fontId);
+    if (it == registry->fonts.end() || it->second.name != fontName) {
+      return flecs::entity();
+    }
+    return it->second.entity;
+  }
+
   // 指定した名前のフォントCDエンティティを検索して返す
   // 引数: fontName - 検索するフォント名
   // 戻り値:
   // 該当するフォントCDのflecs::entity。見つからない場合は無効なentityを返す
   static flecs::entity FindFontCD(flecs::world& world,
                                   s3d::StringView fontName) {
-    // フォントCDを全て走査して、nameが一致するentityを返す
-    flecs::entity foundEntity;
-    world.each<FontSharedCD>(
-      [&foundEntity, fontName](flecs::entity e, const FontSharedCD& fontCD) {
-        // nameが一致したらfoundEntityにセット
-        if (fontCD.name == fontName) {
-          foundEntity = e;
-        }
-      });
-    // 見つかったentityを返す（見つからなければ無効なentity）
-    return foundEntity;
+    return FindFontCD(world, ToFontId(fontName), fontName);
   }
 
   // 標準フォント（StandardFont）のs3d::Fontを取得する
@@ -35,7 +93,7 @@ struct FontUtil {
   // 標準フォントのs3d::Font。見つからない場合はデフォルトフォントを返す
   static s3d::Font GetStandardFont(flecs::world& world) {
     // StandardFontという名前のフォントエンティティを検索
-    flecs::entity standardFontEntity = FindFontCD(world, StandardFontName);
+    flecs::entity standardFontEntity = FindFontCD(world, StandardFontId, StandardFontName);
 
     // 見つかった場合はそのフォントを返す
     if (standardFontEntity.is_valid()) {
@@ -48,4 +106,19 @@ struct FontUtil {
     // 見つからない場合はデフォルトフォントを返す
     return s3d::Font();
   }
+
+  private:
+  static void UnregisterFont(FontRegistrySingletonCD& registry,
+                             flecs::entity e) {
+    const auto it = registry.font_ids.find(e.id());
+    if (it == registry.font_ids.end()) {
+      return;
+    }
+    // 同じ名前で後から登録された別のエンティティは消さない
+    const auto font_it = registry.fonts.find(it->second);
+    if (font_it != registry.fonts.end() && font_it->second.entity == e) {
+      registry.fonts.erase(font_it);
+    }
+    registry.font_ids.erase(it);
+  }
 };
@@ -0,0 +1,257 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+// Siv3Dと衝突しないマクロ設定でWindows.hを読み込む
+#include <Siv3D/Windows/Windows.hpp>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#elif defined(__linux__)
+#include <time.h>
+#endif
+
+// 一定のフレームレートでSystem::Update()を呼ぶためのフレームペーサー
+// 期限の少し手前までOSのタイマーで眠り（Windowsは高精度待機可能タイマー、Linuxはclock_nanosleep）、
+// 残りの短い時間だけスピンして期限に合わせる。スピンする幅は実際の寝過ごし量から自動で調整する
+// System::Update()（描画と表示）の所要時間を計測し、遅れたフレームが次の枠にかかる場合はその枠を飛ばして
+// 次の枠の境界まで待つ（表示の間隔を一定に保つ）
+//   Graphics::SetVSyncEnabled(false);
+//   FramePacer::SetTargetFPS(60);
+//   while (FramePacer::Update()) { ... }
+// SetTargetFPS()を呼ぶまでは待ちを行わず（VSyncに任せる）、フレーム間隔の計測だけを行う
+// VSyncと併用すると待ちが二重になるため、有効にする場合はVSyncを無効にしておくこと
+class FramePacer {
+  public:
+  FramePacer() = delete;
+
+  using Clock = std::chrono::steady_clock;
+
+  // フレーム間隔のばらつき（直近kStatsCapacityフレーム）
+  struct Stats {
+    int32 frames = 0;             // 統計に含まれるフレーム数
+    int32 skipped = 0;            // 飛ばした枠の数（ResetStats()以降の合計）
+    double mean_ms = 0.0;         // フレーム間隔の平均
+    double stddev_ms = 0.0;       // フレーム間隔の標準偏差
+    double p99_error_ms = 0.0;    // 目標間隔からのずれの99パーセンタイル
+    double max_error_ms = 0.0;    // 目標間隔からのずれの最大値
+    double spin_margin_ms = 0.0;  // 現在のスピン待ちの幅
+    double render_cost_ms = 0.0;  // System::Update()の所要時間（指数移動平均）
+  };
+
+  static constexpr size_t kStatsCapacity = 600;
+
+  // 目標のフレームレートを設定し、FramePacerによる待ちを有効にする
+  static void SetTargetFPS(int32 fps) {
+    s_period = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1.0 / Max(fps, 1)));
+    s_is_started = false;
+    s_is_enabled = true;
+  }
+
+  // 待ちを無効にしてVSyncに任せる（フレーム間隔の計測は続ける）
+  static void Disable() {
+    s_is_enabled = false;
+    s_is_started = false;
+  }
+
+  static bool IsEnabled() { return s_is_enabled; }
+
+  // System::Update()の代わりに呼ぶ
+  static bool Update() {
+    BeginFrame();
+    const bool result = System::Update();
+    EndFrame();
+    return result;
+  }
+
+  // 次の枠の期限まで待つ（Update()を使わない場合はSystem::Update()の直前に呼ぶ）
+  static void BeginFrame() {
+    const auto now = Clock::now();
+    if (!s_is_enabled) {
+      if (s_is_started) {
+        RecordInterval(now - s_last_begin);
+      }
+      s_is_started = true;
+      s_last_begin = now;
+      return;
+    }
+    if (!s_is_started) {
+      s_is_started = true;
+      s_deadline = now;
+      s_last_begin = now;
+      return;
+    }
+
+    // 期限を過ぎていて、今から表示すると次の枠にもかかる場合はその枠を飛ばす
+    const auto late = now - s_deadline;
+    if (late > Clock::duration::zero()) {
+      const auto missed = (late + s_render_cost) / s_period;
+      s_deadline += s_period * missed;
+      s_skipped += static_cast<int32>(missed);
+    }
+
+    WaitUntil(s_deadline);
+    const auto begin = Clock::now();
+    RecordInterval(begin - s_last_begin);
+    s_last_begin = begin;
+  }
+
+  // System::Update()の直後に呼ぶ
+  static void EndFrame() {
+    if (!s_is_enabled) {
+      return;
+    }
+    const auto now = Clock::now();
+    // 表示にかかった時間を平滑化して覚えておく
+    const auto cost = now - s_last_begin;
+    s_render_cost += (cost - s_render_cost) / 8;
+    s_deadline += s_period;
+  }
+
+  static Stats GetStats() {
+    Stats stats;
+    stats.skipped = s_skipped;
+    stats.spin_margin_ms = ToMs(s_spin_margin);
+    stats.render_cost_ms = ToMs(s_render_cost);
+    stats.frames = static_cast<int32>(s_intervals.size());
+    if (s_intervals.empty()) {
+      return stats;
+    }
+
+    double sum = 0.0;
+    for (const double interval : s_intervals) {
+      sum += interval;
+    }
+    stats.mean_ms = sum / s_intervals.size();
+
+    const double target_ms = ToMs(s_period);
+    double variance = 0.0;
+    std::vector<double> errors;
+    errors.reserve(s_intervals.size());
+    for (const double interval : s_intervals) {
+      variance += (interval - stats.mean_ms) * (interval - stats.mean_ms);
+      errors.push_back(std::abs(interval - target_ms));
+    }
+    stats.stddev_ms = std::sqrt(variance / s_intervals.size());
+
+    const size_t p99 = (errors.size() - 1) * 99 / 100;
+    std::nth_element(errors.begin(), errors.begin() + p99, errors.end());
+    stats.p99_error_ms = errors[p99];
+    stats.max_error_ms = *std::max_element(errors.begin(), errors.end());
+    return stats;
+  }
+
+  static void ResetStats() {
+    s_intervals.clear();
+    s_next_interval = 0;
+    s_skipped = 0;
+  }
+
+  private:
+  // 期限のspin_margin手前までOSのタイマーで眠り、残りをスピンで待つ
+  static void WaitUntil(Clock::time_point deadline) {
+    const auto sleep_until = deadline - s_spin_margin;
+    const auto now = Clock::now();
+    if (sleep_until > now) {
+      SleepFor(sleep_until - now);
+      AdaptSpinMargin(Clock::now() - sleep_until);
+    }
+    while (Clock::now() < deadline) {
+      std::this_thread::yield();
+    }
+  }
+
+  // 寝過ごした量に合わせてスピンの幅を広げ、寝過ごさなければ少しずつ狭める
+  static void AdaptSpinMargin(Clock::duration oversleep) {
+    const auto wanted = oversleep + kSpinSafety;
+    if (wanted > s_spin_margin) {
+      s_spin_margin = wanted;
+    } else {
+      s_spin_margin -= (s_spin_margin - wanted) / 64;
+    }
+    s_spin_margin = std::clamp<Clock::duration>(s_spin_margin, kMinSpinMargin,
+                                                kMaxSpinMargin);
+  }
+
+  static void SleepFor(Clock::duration duration) {
+#ifdef _WIN32
+    static const HANDLE timer = CreateTimer();
+    if (timer) {
+      LARGE_INTEGER due;
+      // 負の値は100ns単位の相対時間
+      due.QuadPart = -std::chrono::duration_cast<
+                        std::chrono::duration<LONGLONG, std::ratio<1, 10000000>>>(
+                        duration)
+                        .count();
+      if (SetWaitableTimerEx(timer, &due, 0, nullptr, nullptr, nullptr, 0)) {
+        WaitForSingleObject(timer, INFINITE);
+        return;
+      }
+    }
+    std::this_thread::sleep_for(duration);
+#elif defined(__linux__)
+    const auto ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    timespec ts{static_cast<time_t>(ns / 1000000000),
+                static_cast<long>(ns % 1000000000)};
+    while (clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, &ts) == EINTR) {
+    }
+#else
+    std::this_thread::sleep_for(duration);
+#endif
+  }
+
+#ifdef _WIN32
+  // 高精度タイマーが使えない古いWindowsでは通常の待機可能タイマーにする
+  static HANDLE CreateTimer() {
+    HANDLE timer = CreateWaitableTimerExW(
+      nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+      TIMER_ALL_ACCESS);
+    if (!timer) {
+      timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+    }
+    return timer;
+  }
+#endif
+
+  static void RecordInterval(Clock::duration interval) {
+    const double ms = ToMs(interval);
+    if (s_intervals.size() < kStatsCapacity) {
+      s_intervals.push_back(ms);
+      return;
+    }
+    s_intervals[s_next_interval] = ms;
+    s_next_interval = (s_next_interval + 1) % kStatsCapacity;
+  }
+
+  static double ToMs(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  }
+
+  static constexpr Clock::duration kMinSpinMargin =
+    std::chrono::microseconds(100);
+  static constexpr Clock::duration kMaxSpinMargin =
+    std::chrono::milliseconds(4);
+  static constexpr Clock::duration kSpinSafety = std::chrono::microseconds(50);
+
+  static inline Clock::duration s_period =
+    std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(1.0 / 60.0));
+  static inline Clock::duration s_spin_margin = std::chrono::milliseconds(1);
+  static inline Clock::duration s_render_cost = Clock::duration::zero();
+  static inline Clock::time_point s_deadline;
+  static inline Clock::time_point s_last_begin;
+  static inline bool s_is_started = false;
+  static inline bool s_is_enabled = false;
+
+  static inline std::vector<double> s_intervals;
+  static inline size_t s_next_interval = 0;
+  static inline int32 s_skipped = 0;
+};
@@ -0,0 +1,453 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+#include "flecs/flecs.h"
+
+// フレーム内の処理時間を区間ごとに計測するプロファイラー
+// 計測したい処理をScopeで囲むと、スレッドごとのリングバッファに開始・終了のタイムスタンプが記録される
+//   void Update() {
+//     const FrameProfiler::Scope scope{"SoundManager::Update"};
+//     ...
+//   }
+// 名前は文字列リテラルなど、プログラムの終了まで有効な文字列を渡すこと
+// 無効化中（既定）のScopeはフラグを1回読むだけで何もしない
+// flecsのシステムはInstallFlecsHooks()でシステムごとに自動で計測される（FLECS_PERF_TRACEが必要）
+// メインループの先頭でBeginFrame()を呼ぶと、直前のフレームを名前ごとに集計し、直近kHistoryFramesフレームの
+// p50/p99をDrawOverlay()で表示、ExportChromeTrace()でchrome://tracing形式のJSONに書き出せる
+class FrameProfiler {
+  public:
+  FrameProfiler() = delete;
+
+  static constexpr size_t kEventCapacity = 16384;  // スレッドごとに保持する区間の数
+  static constexpr size_t kMaxDepth = 64;          // 入れ子の最大数
+  static constexpr size_t kHistoryFrames = 120;    // p50/p99の集計に使うフレーム数
+
+  // 計測した1区間（タイムスタンプはReadTicks()の単位）
+  struct Event {
+    const char* name = nullptr;
+    uint64 begin = 0;
+    uint64 end = 0;
+    uint32 depth = 0;
+  };
+
+  // 名前ごとの集計（1フレーム内の合計時間）
+  struct Summary {
+    std::string_view name;
+    uint32 thread_index = 0;
+    double last_ms = 0.0;
+    double p50_ms = 0.0;
+    double p99_ms = 0.0;
+  };
+
+  class Scope {
+    public:
+    explicit Scope(const char* name) : m_is_active(IsEnabled()) {
+      if (m_is_active) {
+        Begin(name);
+      }
+    }
+    ~Scope() {
+      if (m_is_active) {
+        End();
+      }
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    private:
+    bool m_is_active;
+  };
+
+  static void SetEnabled(bool enabled) {
+    s_is_enabled.store(enabled, std::memory_order_relaxed);
+  }
+
+  static bool IsEnabled() {
+    return s_is_enabled.load(std::memory_order_relaxed);
+  }
+
+  // 呼び出したスレッドの表示名を設定する（トレースとオーバーレイで使う）
+  static void SetThreadName(const char* name) { GetThreadBuffer().name = name; }
+
+  // 区間の開始と終了（通常はScopeを使う）
+  static void Begin(const char* name) {
+    ThreadBuffer& buffer = GetThreadBuffer();
+    if (buffer.depth < kMaxDepth) {
+      buffer.stack[buffer.depth] = {name, ReadTicks()};
+    }
+    ++buffer.depth;
+  }
+
+  static void End() {
+    ThreadBuffer& buffer = GetThreadBuffer();
+    if (buffer.depth == 0) {
+      return;  // 計測の途中で有効にした場合など
+    }
+    --buffer.depth;
+    if (buffer.depth >= kMaxDepth) {
+      return;
+    }
+    const OpenScope& open = buffer.stack[buffer.depth];
+    const uint64 index = buffer.count.load(std::memory_order_relaxed);
+    buffer.events[index % kEventCapacity] = {open.name, open.begin,
+                                             ReadTicks(), buffer.depth};
+    buffer.count.store(index + 1, std::memory_order_release);
+  }
+
+  // flecsのシステム実行ごとに区間を記録する
+  // flecs内部の細かい処理（flecs.commitなど）は数が多すぎるため除外する
+  static void InstallFlecsHooks() {
+    ecs_os_api.perf_trace_push_ = [](const char*, size_t, const char* name) {
+      if (IsEnabled() && !IsFlecsInternal(name)) {
+        Begin(InternName(name));
+      }
+    };
+    ecs_os_api.perf_trace_pop_ = [](const char*, size_t, const char* name) {
+      if (IsEnabled() && !IsFlecsInternal(name)) {
+        End();
+      }
+    };
+  }
+
+  // メインループの先頭で呼ぶ（メインスレッドのみ）
+  static void BeginFrame() {
+    // 計測中に有効・無効が切り替わって閉じられなかった区間を捨てる
+    GetThreadBuffer().depth = 0;
+    const uint64 now = ReadTicks();
+    Calibrate(now);
+    if (IsEnabled() && s_frame_begin != 0) {
+      CollectFrame(s_frame_begin, now);
+    }
+    s_frame_begin = now;
+  }
+
+  // 名前ごとの集計をp99の大きい順に返す
+  static Array<Summary> GetSummaries() {
+    Array<Summary> summaries;
+    std::vector<double> sorted;
+    for (const auto& [name, history] : s_history) {
+      sorted.assign(history.frames.begin(),
+                    history.frames.begin() + history.size);
+      if (sorted.empty()) {
+        continue;
+      }
+      std::sort(sorted.begin(), sorted.end());
+      Summary summary;
+      summary.name = name;
+      summary.thread_index = history.thread_index;
+      summary.last_ms = history.frames[(history.next + kHistoryFrames - 1) %
+                                       kHistoryFrames];
+      summary.p50_ms = sorted[(sorted.size() - 1) * 50 / 100];
+      summary.p99_ms = sorted[(sorted.size() - 1) * 99 / 100];
+      summaries.push_back(summary);
+    }
+    summaries.sort_by([](const Summary& a, const Summary& b) {
+      return a.p99_ms > b.p99_ms;
+    });
+    return summaries;
+  }
+
+  // 直前のフレームのメインスレッドのフレームグラフと、名前ごとの集計表を描画する
+  static void DrawOverlay(const Font& font, const Vec2& pos, double width = 480.0,
+                          int32 max_rows = 16) {
+    constexpr double kRowHeight = 14.0;
+    constexpr double kFontSize = 12.0;
+    const double budget_ms = 1000.0 / 60.0;
+    const double frame_ms = Max(TicksToMs(s_last_frame_ticks), budget_ms);
+
+    int32 max_depth = 0;
+    for (const Event& e : s_last_frame_events) {
+      max_depth = Max(max_depth, static_cast<int32>(e.depth) + 1);
+    }
+    const double graph_height = Max(max_depth, 1) * kRowHeight;
+    const Array<Summary> summaries = GetSummaries();
+    const int32 rows = Min(max_rows, static_cast<int32>(summaries.size()));
+    const RectF background{pos, width + 16.0,
+                           graph_height + (rows + 2) * kRowHeight + 24.0};
+    background.draw(ColorF{0.0, 0.7});
+
+    // フレームグラフ（横幅はフレームの長さ。予算を超えた部分は赤線の右側）
+    const Vec2 graph_pos = pos + Vec2{8.0, 8.0};
+    font(U"main thread {:.2f} ms"_fmt(
+           TicksToMs(s_last_frame_ticks)))
+      .draw(kFontSize, graph_pos, Palette::White);
+    const Vec2 bars_pos = graph_pos + Vec2{0.0, kRowHeight + 2.0};
+    for (const Event& e : s_last_frame_events) {
+      const double x =
+        TicksToMs(e.begin - s_last_frame_begin) / frame_ms * width;
+      const double w = Max(TicksToMs(e.end - e.begin) / frame_ms * width, 1.0);
+      const RectF rect{bars_pos.x + x, bars_pos.y + e.depth * kRowHeight, w,
+                       kRowHeight - 1.0};
+      rect.draw(ColorOf(e.name));
+      if (w > 40.0) {
+        font(Unicode::FromUTF8(e.name))
+          .draw(kFontSize - 2.0, rect.pos.movedBy(2, 0), Palette::Black);
+      }
+    }
+    const double budget_x = bars_pos.x + budget_ms / frame_ms * width;
+    Line{budget_x, bars_pos.y, budget_x, bars_pos.y + graph_height}.draw(
+      2.0, Palette::Red);
+
+    // 集計表
+    Vec2 row_pos = bars_pos + Vec2{0.0, graph_height + 4.0};
+    font(U"name / thread / last / p50 / p99 (ms, {} frames)"_fmt(
+           kHistoryFrames))
+      .draw(kFontSize, row_pos, Palette::White);
+    const std::lock_guard<std::mutex> lock(s_buffers_mutex);
+    for (int32 i = 0; i < rows; ++i) {
+      row_pos.y += kRowHeight;
+      const Summary& s = summaries[i];
+      RectF{row_pos.movedBy(0, 3), 8, 8}.draw(ColorOf(s.name.data()));
+      font(U"{} / {} / {:.2f} / {:.2f} / {:.2f}"_fmt(
+             Unicode::FromUTF8(s.name), GetThreadName(s.thread_index),
+             s.last_ms, s.p50_ms, s.p99_ms))
+        .draw(kFontSize, row_pos.movedBy(12, 0), Palette::White);
+    }
+  }
+
+  // 記録中の全スレッドの区間をChromeのトレース形式（chrome://tracing、Perfetto）で書き出す
+  static bool ExportChromeTrace(FilePathView path) {
+    TextWriter writer{path};
+    if (!writer) {
+      Console << U"FrameProfiler: " << path << U" を開けませんでした";
+      return false;
+    }
+
+    writer.writeln(U"{\"traceEvents\":[");
+    bool is_first = true;
+    const auto write_event = [&](const String& json) {
+      writer.write(is_first ? U"" : U",\n");
+      writer.write(json);
+      is_first = false;
+    };
+
+    std::vector<Event> events;
+    const std::lock_guard<std::mutex> lock(s_buffers_mutex);
+    for (const auto& buffer : s_buffers) {
+      write_event(
+        U"{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{},"
+        U"\"args\":{{\"name\":\"{}\"}}}}"_fmt(
+          buffer->index, GetThreadName(buffer->index)));
+
+      events.clear();
+      Snapshot(*buffer, 0, events);
+      for (const Event& e : events) {
+        write_event(
+          U"{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":0,\"tid\":{},"
+          U"\"ts\":{:.3f},\"dur\":{:.3f}}}"_fmt(
+            EscapeJson(e.name), buffer->index,
+            TicksToMs(e.begin - s_origin_ticks) * 1000.0,
+            TicksToMs(e.end - e.begin) * 1000.0));
+      }
+    }
+    writer.writeln(U"\n]}");
+    Console << U"FrameProfiler: " << path << U" に書き出しました";
+    return true;
+  }
+
+  private:
+  struct OpenScope {
+    const char* name = nullptr;
+    uint64 begin = 0;
+  };
+
+  struct ThreadBuffer {
+    uint32 index = 0;
+    const char* name = nullptr;
+    uint32 depth = 0;
+    std::array<OpenScope, kMaxDepth> stack;
+    std::array<Event, kEventCapacity> events;
+    // 書き込んだ区間の総数（読み出し側はこの値で上書きされていない範囲を判定する）
+    std::atomic<uint64> count{0};
+  };
+
+  // 名前ごとの直近kHistoryFramesフレームの合計時間
+  struct History {
+    uint32 thread_index = 0;
+    std::array<double, kHistoryFrames> frames{};
+    size_t next = 0;
+    size_t size = 0;
+  };
+
+  // x86ではTSC（不変TSCを前提）、それ以外ではsteady_clockのナノ秒
+  static uint64 ReadTicks() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#else
+    return static_cast<uint64>(
+      std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+  }
+
+  // 起動からの経過時間とティック数の比から、ティックの長さを求め直す
+  static void Calibrate(uint64 now_ticks) {
+    const double elapsed_ms =
+      std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - s_origin_time)
+        .count();
+    if (elapsed_ms > 1.0 && now_ticks > s_origin_ticks) {
+      s_ms_per_tick = elapsed_ms / static_cast<double>(now_ticks - s_origin_ticks);
+    }
+  }
+
+  static double TicksToMs(uint64 ticks) {
+    return static_cast<double>(ticks) * s_ms_per_tick;
+  }
+
+  static ThreadBuffer& GetThreadBuffer() {
+    thread_local ThreadBuffer* t_buffer = nullptr;
+    if (!t_buffer) {
+      auto buffer = std::make_unique<ThreadBuffer>();
+      const std::lock_guard<std::mutex> lock(s_buffers_mutex);
+      buffer->index = static_cast<uint32>(s_buffers.size());
+      t_buffer = buffer.get();
+      s_buffers.push_back(std::move(buffer));
+    }
+    return *t_buffer;
+  }
+
+  // s_buffers_mutexをロックした状態で呼ぶ
+  static String GetThreadName(uint32 index) {
+    const char* name = (index < s_buffers.size()) ? s_buffers[index]->name
+                                                  : nullptr;
+    return name ? Unicode::FromUTF8(name) : U"thread {}"_fmt(index);
+  }
+
+  // 終了がsince以降の区間を古い順にoutへ追加する
+  // 書き込み中のスレッドに追い越された区間は、読み終えた後のcountで判定して捨てる
+  static void Snapshot(const ThreadBuffer& buffer, uint64 since,
+                       std::vector<Event>& out) {
+    const uint64 count = buffer.count.load(std::memory_order_acquire);
+    const uint64 first = (count > kEventCapacity) ? count - kEventCapacity : 0;
+    uint64 begin = count;
+    while (begin > first && buffer.events[(begin - 1) % kEventCapacity].end >= since) {
+      --begin;
+    }
+    const size_t offset = out.size();
+    for (uint64 i = begin; i < count; ++i) {
+      out.push_back(buffer.events[i % kEventCapacity]);
+    }
+    const uint64 after = buffer.count.load(std::memory_order_acquire);
+    const uint64 overwritten =
+      (after > kEventCapacity) ? after - kEventCapacity : 0;
+    if (overwritten > begin) {
+      const size_t drop = static_cast<size_t>(
+        Min<uint64>(overwritten - begin, count - begin));
+      out.erase(out.begin() + offset, out.begin() + offset + drop);
+    }
+  }
+
+  // [begin, end)に終わった区間を名前ごとに合計して履歴に追加する
+  static void CollectFrame(uint64 begin, uint64 end) {
+    std::unordered_map<std::string_view, double> totals;
+    std::unordered_map<std::string_view, uint32> threads;
+    std::vector<Event> events;
+    const ThreadBuffer* main_buffer = &GetThreadBuffer();
+    {
+      const std::lock_guard<std::mutex> lock(s_buffers_mutex);
+      for (const auto& buffer : s_buffers) {
+        events.clear();
+        Snapshot(*buffer, begin, events);
+        for (const Event& e : events) {
+          if (e.end >= end) {
+            continue;
+          }
+          totals[e.name] += TicksToMs(e.end - e.begin);
+          threads[e.name] = buffer->index;
+        }
+        // メインスレッド（BeginFrameを呼ぶスレッド）はフレームグラフ用に保存しておく
+        if (buffer.get() == main_buffer) {
+          s_last_frame_events.clear();
+          for (const Event& e : events) {
+            if (e.begin >= begin && e.end < end) {
+              s_last_frame_events.push_back(e);
+            }
+          }
+        }
+      }
+    }
+    s_last_frame_begin = begin;
+    s_last_frame_ticks = end - begin;
+
+    for (const auto& [name, ms] : totals) {
+      s_history[name].thread_index = threads[name];
+    }
+    // このフレームに現れなかった名前は0として記録する
+    for (auto& [name, history] : s_history) {
+      const auto it = totals.find(name);
+      history.frames[history.next] = (it != totals.end()) ? it->second : 0.0;
+      history.next = (history.next + 1) % kHistoryFrames;
+      history.size = Min(history.size + 1, kHistoryFrames);
+    }
+  }
+
+  static bool IsFlecsInternal(const char* name) {
+    return !name || std::strncmp(name, "flecs.", 6) == 0;
+  }
+
+  // flecsのシステム名はworldの破棄とともに解放されるため、プロファイラー側で複製して持つ
+  // 同じポインタに別の名前が入る場合に備え、キャッシュの一致は中身でも確認する
+  static const char* InternName(const char* name) {
+    thread_local std::unordered_map<const char*, const char*> t_cache;
+    if (const auto it = t_cache.find(name);
+        it != t_cache.end() && std::strcmp(it->second, name) == 0) {
+      return it->second;
+    }
+    const std::lock_guard<std::mutex> lock(s_names_mutex);
+    const char* interned = s_names.emplace(name).first->c_str();
+    t_cache[name] = interned;
+    return interned;
+  }
+
+  // 名前から決まる色（フレームをまたいで同じ処理を同じ色にする）
+  static ColorF ColorOf(const char* name) {
+    const uint64 hash = std::hash<std::string_view>{}(name);
+    return HSV{static_cast<double>(hash % 360), 0.45, 0.95}.toColorF();
+  }
+
+  static String EscapeJson(const char* name) {
+    String escaped;
+    for (const char32 c : Unicode::FromUTF8(name)) {
+      if (c == U'"' || c == U'\\') {
+        escaped.push_back(U'\\');
+      }
+      escaped.push_back(c);
+    }
+    return escaped;
+  }
+
+  static inline std::atomic<bool> s_is_enabled{false};
+
+  static inline std::mutex s_buffers_mutex;
+  static inline std::vector<std::unique_ptr<ThreadBuffer>> s_buffers;
+
+  static inline std::mutex s_names_mutex;
+  static inline std::unordered_set<std::string> s_names;
+
+  static inline const uint64 s_origin_ticks = ReadTicks();
+  static inline const std::chrono::steady_clock::time_point s_origin_time =
+    std::chrono::steady_clock::now();
+  static inline double s_ms_per_tick = 1e-6;
+
+  static inline uint64 s_frame_begin = 0;
+  static inline uint64 s_last_frame_begin = 0;
+  static inline uint64 s_last_frame_ticks = 0;
+  static inline std::vector<Event> s_last_frame_events;
+  static inline std::unordered_map<std::string_view, History> s_history;
+};
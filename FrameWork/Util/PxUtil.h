@@ -21,6 +21,15 @@ physx::PxVec3 ToVec(const Vec3& vec) {
 
 Vec3 ToSivVec(const physx::PxVec3& vec) { return Vec3(vec.x, vec.y, vec.z); }
 
+// ActorのuserDataにIDを埋め込む（エンティティIDの逆引きをハッシュ検索なしで行うため）
+static_assert(sizeof(void*) >= sizeof(uint64_t), "userDataに64bitのIDを格納できません");
+void SetUserId(physx::PxActor& actor, uint64_t id) {
+  actor.userData = reinterpret_cast<void*>(static_cast<uintptr_t>(id));
+}
+uint64_t GetUserId(const physx::PxActor& actor) {
+  return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(actor.userData));
+}
+
 void SetTrigger(physx::PxShape& shape) {
   shape.setFlag(physx::PxShapeFlag::eSIMULATION_SHAPE, false);
   shape.setFlag(physx::PxShapeFlag::eTRIGGER_SHAPE, true);
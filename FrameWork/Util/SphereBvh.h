@@ -0,0 +1,182 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+// 球の集合に対するレイキャスト用の軽量BVH
+// PhysXのActorを持たない選択対象のピッキングに使う（構築O(n log n)、レイキャストO(log n)）
+// 対象が動いた場合はBuild()で作り直す
+class SphereBvh {
+  public:
+  struct Item {
+    uint64 id = 0;
+    Sphere sphere;
+  };
+
+  struct Hit {
+    uint64 id = 0;
+    float distance = 0.0f;
+  };
+
+  void Build(std::vector<Item> items) {
+    m_items = std::move(items);
+    m_nodes.clear();
+    if (m_items.empty()) {
+      return;
+    }
+    m_nodes.reserve(m_items.size() * 2 / kLeafSize + 1);
+    m_nodes.emplace_back();
+    BuildNode(0, 0, static_cast<uint32>(m_items.size()));
+  }
+
+  void Clear() {
+    m_items.clear();
+    m_nodes.clear();
+  }
+
+  bool IsEmpty() const { return m_items.empty(); }
+
+  // レイと最初に交差する球を返す
+  Optional<Hit> Raycast(const Ray& ray,
+                        float max_distance =
+                          std::numeric_limits<float>::max()) const {
+    if (m_nodes.empty()) {
+      return none;
+    }
+
+    const Float3 origin = ray.getOrigin();
+    const Float3 dir = ray.getDirection();
+    const Float3 inv_dir{1.0f / dir.x, 1.0f / dir.y, 1.0f / dir.z};
+
+    Optional<Hit> best;
+    float best_distance = max_distance;
+
+    // 近い子ノードから辿り、既知の最近交点より遠いノードは枝刈りする
+    uint32 stack[64];
+    int32 stack_size = 0;
+    stack[stack_size++] = 0;
+    while (stack_size > 0) {
+      const Node& node = m_nodes[stack[--stack_size]];
+      float t_node;
+      if (!IntersectAabb(node, origin, inv_dir, best_distance, t_node)) {
+        continue;
+      }
+
+      if (node.count > 0) {
+        for (uint32 i = node.first; i < node.first + node.count; ++i) {
+          const auto t = ray.intersects(m_items[i].sphere);
+          if (t && *t < best_distance) {
+            best_distance = *t;
+            best = Hit{m_items[i].id, *t};
+          }
+        }
+        continue;
+      }
+
+      const uint32 left = node.first;
+      const uint32 right = node.first + 1;
+      float t_left, t_right;
+      const bool hit_left = IntersectAabb(m_nodes[left], origin, inv_dir,
+                                          best_distance, t_left);
+      const bool hit_right = IntersectAabb(m_nodes[right], origin, inv_dir,
+                                           best_distance, t_right);
+      // 後から積んだ方が先に処理されるため、遠い方を先に積む
+      if (hit_left && hit_right) {
+        if (t_left <= t_right) {
+          stack[stack_size++] = right;
+          stack[stack_size++] = left;
+        } else {
+          stack[stack_size++] = left;
+          stack[stack_size++] = right;
+        }
+      } else if (hit_left) {
+        stack[stack_size++] = left;
+      } else if (hit_right) {
+        stack[stack_size++] = right;
+      }
+    }
+    return best;
+  }
+
+  private:
+  // 葉ノードはcount > 0でm_items[first, first + count)を持つ
+  // 内部ノードはcount == 0で子ノードがm_nodes[first]とm_nodes[first + 1]
+  struct Node {
+    Float3 min;
+    Float3 max;
+    uint32 first = 0;
+    uint32 count = 0;
+  };
+
+  static constexpr uint32 kLeafSize = 4;
+
+  // 中央値で分割する（子ノードは連続して確保する）
+  // emplace_backで参照が無効になるため、ノードには常にインデックスでアクセスする
+  void BuildNode(uint32 index, uint32 begin, uint32 end) {
+    Float3 min = Float3::All(std::numeric_limits<float>::max());
+    Float3 max = Float3::All(std::numeric_limits<float>::lowest());
+    for (uint32 i = begin; i < end; ++i) {
+      const Float3 center{m_items[i].sphere.center};
+      const float r = static_cast<float>(m_items[i].sphere.r);
+      min = Float3{Min(min.x, center.x - r), Min(min.y, center.y - r),
+                   Min(min.z, center.z - r)};
+      max = Float3{Max(max.x, center.x + r), Max(max.y, center.y + r),
+                   Max(max.z, center.z + r)};
+    }
+    m_nodes[index].min = min;
+    m_nodes[index].max = max;
+
+    if (end - begin <= kLeafSize) {
+      m_nodes[index].first = begin;
+      m_nodes[index].count = end - begin;
+      return;
+    }
+
+    // 最も長い軸で分割
+    const Float3 extent = max - min;
+    const int32 axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0
+                       : (extent.y >= extent.z)                      ? 1
+                                                                     : 2;
+    const uint32 mid = begin + (end - begin) / 2;
+    std::nth_element(m_items.begin() + begin, m_items.begin() + mid,
+                     m_items.begin() + end,
+                     [axis](const Item& a, const Item& b) {
+                       return a.sphere.center.elem(axis) <
+                              b.sphere.center.elem(axis);
+                     });
+
+    const uint32 children = static_cast<uint32>(m_nodes.size());
+    m_nodes.emplace_back();
+    m_nodes.emplace_back();
+    m_nodes[index].first = children;
+    m_nodes[index].count = 0;
+    BuildNode(children, begin, mid);
+    BuildNode(children + 1, mid, end);
+  }
+
+  // スラブ法でレイとAABBの交差判定（t_nearに入口の距離を返す）
+  static bool IntersectAabb(const Node& node, const Float3& origin,
+                            const Float3& inv_dir, float max_distance,
+                            float& t_near) {
+    float t_min = 0.0f;
+    float t_max = max_distance;
+    for (int32 axis = 0; axis < 3; ++axis) {
+      float t0 = (node.min.elem(axis) - origin.elem(axis)) * inv_dir.elem(axis);
+      float t1 = (node.max.elem(axis) - origin.elem(axis)) * inv_dir.elem(axis);
+      if (t0 > t1) {
+        std::swap(t0, t1);
+      }
+      t_min = Max(t_min, t0);
+      t_max = Min(t_max, t1);
+      if (t_max < t_min) {
+        return false;
+      }
+    }
+    t_near = t_min;
+    return true;
+  }
+
+  std::vector<Item> m_items;
+  std::vector<Node> m_nodes;
+};
@@ -0,0 +1,147 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+
+// 複数の画像を大きなテクスチャ（ページ）に詰め込むアトラス
+// スプライトやアニメーションのフレームを同じテクスチャの別領域として描画できるようにし、
+// テクスチャの切り替えとドローコールを減らす
+// 詰め込みは読み込み時にCPU側の画像へ行い、Upload()でまとめてGPUへ転送する
+// ページはミップマップを持つため、各画像の周囲paddingピクセルに縁の色を引き伸ばして書き込む
+// （縮小率がおよそ2/padding倍までは、縮小したミップレベルでも隣の画像の色が混ざらない）
+class SpriteAtlas {
+  public:
+  // アトラス上の領域
+  struct Region {
+    Texture texture;  // ページのテクスチャ（同じページの領域は同じハンドルを共有する）
+    Rect rect;
+  };
+
+  // padding: 画像の上下左右に確保する余白（ピクセル）
+  explicit SpriteAtlas(const Size& page_size = Size{2048, 2048},
+                       int32 padding = 8)
+      : m_page_size(page_size), m_padding(padding) {}
+
+  // 画像ファイルを読み込んで詰め込む（同じパスは1回だけ詰め込む）
+  Optional<Region> Load(FilePathView path) {
+    if (auto it = m_regions.find(FilePath{path}); it != m_regions.end()) {
+      return it->second;
+    }
+    const Image image{path};
+    if (!image) {
+      s3d::Console << U"SpriteAtlas: 画像の読み込みに失敗しました (" << path
+                   << U")";
+      return none;
+    }
+    return Add(path, image);
+  }
+
+  // 絵文字を詰め込む
+  Optional<Region> Load(const Emoji& emoji) {
+    const String key = U"emoji:" + emoji.codePoints;
+    if (auto it = m_regions.find(key); it != m_regions.end()) {
+      return it->second;
+    }
+    return Add(key, Image{emoji});
+  }
+
+  // 画像をkeyの領域として詰め込む
+  // ページより大きい画像は詰め込まず、単独のテクスチャを1枚の領域として返す
+  Region Add(StringView key, const Image& image) {
+    Region region;
+    if (const auto placed = Place(image.size())) {
+      Page& page = m_pages[placed->first];
+      const Point pos = placed->second + Point{m_padding, m_padding};
+      WriteExtruded(page.image, image, pos, m_padding);
+      page.is_dirty = true;
+      region = Region{page.texture, Rect{pos, image.size()}};
+    } else {
+      region = Region{Texture{image, TextureDesc::MippedSRGB},
+                      Rect{image.size()}};
+    }
+    m_regions.emplace(String{key}, region);
+    return region;
+  }
+
+  // 詰め込んだ内容をGPUへ転送する（変更のあったページのみ）
+  void Upload() {
+    for (auto& page : m_pages) {
+      if (page.is_dirty) {
+        page.texture.fill(page.image);
+        page.is_dirty = false;
+      }
+    }
+  }
+
+  size_t GetPageCount() const { return m_pages.size(); }
+
+  private:
+  // 1ページ分。行（シェルフ）ごとに左から詰め、入らなければ次の行へ進む
+  struct Page {
+    Image image;
+    DynamicTexture texture;
+    Point cursor{0, 0};
+    int32 shelf_height = 0;
+    bool is_dirty = false;
+  };
+
+  // 余白を含めた領域を詰め込む位置（ページ番号, 余白を含めた左上座標）を決める
+  Optional<std::pair<size_t, Point>> Place(const Size& size) {
+    const Size padded = size + Size{m_padding * 2, m_padding * 2};
+    if (m_page_size.x < padded.x || m_page_size.y < padded.y) {
+      return none;
+    }
+
+    // 先に作ったページから順に空きを探す
+    for (size_t i = 0; i < m_pages.size(); ++i) {
+      if (const auto pos = PlaceInPage(m_pages[i], padded)) {
+        return std::pair{i, *pos};
+      }
+    }
+
+    Page page;
+    page.image = Image{m_page_size, Color{0, 0}};
+    // 個別のテクスチャで読み込んでいたときと同じ設定（縮小描画用のミップマップあり）
+    page.texture = DynamicTexture{page.image, TextureDesc::MippedSRGB};
+    m_pages << std::move(page);
+    return std::pair{m_pages.size() - 1, *PlaceInPage(m_pages.back(), padded)};
+  }
+
+  // 入る場合だけカーソルを進める（入らなかった画像で行を送ると、後の小さい画像が使える空きを失う）
+  static Optional<Point> PlaceInPage(Page& page, const Size& padded) {
+    const Size page_size = page.image.size();
+    Point pos = page.cursor;
+    int32 shelf_height = page.shelf_height;
+    if (page_size.x < pos.x + padded.x) {
+      // 次の行へ
+      pos = Point{0, pos.y + shelf_height};
+      shelf_height = 0;
+    }
+    if (page_size.y < pos.y + padded.y) {
+      return none;
+    }
+    page.cursor = Point{pos.x + padded.x, pos.y};
+    page.shelf_height = Max(shelf_height, padded.y);
+    return pos;
+  }
+
+  // imageをposに書き込み、周囲padding分は最も近い縁のピクセルで埋める
+  static void WriteExtruded(Image& dst, const Image& image, const Point& pos,
+                            int32 padding) {
+    if (image.isEmpty()) {
+      return;
+    }
+    const int32 w = image.width();
+    const int32 h = image.height();
+    for (int32 y = -padding; y < h + padding; ++y) {
+      const Color* src_row = image[Clamp(y, 0, h - 1)];
+      Color* dst_row = dst[pos.y + y];
+      for (int32 x = -padding; x < w + padding; ++x) {
+        dst_row[pos.x + x] = src_row[Clamp(x, 0, w - 1)];
+      }
+    }
+  }
+
+  Size m_page_size;
+  int32 m_padding;
+  Array<Page> m_pages;
+  HashTable<String, Region> m_regions;
+};
@@ -0,0 +1,120 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+#include <array>
+#include <vector>
+
+// 階層型タイマーホイール
+// 「いつ処理するか」が決まっているIDを時刻ごとのスロットに入れておき、時刻が進んだときに
+// 期限が来たスロットだけを取り出す。1フレームのコストは登録数ではなく期限を迎えた数に比例する
+// 時刻はtick_seconds単位のティックに丸める
+// 取り消しはできないため、呼び出し側で期限のティックを覚えておき、古い通知は無視すること
+class TimerWheel {
+  public:
+  explicit TimerWheel(double tick_seconds = 1.0 / 240.0)
+      : m_tick_seconds(tick_seconds) {}
+
+  // 秒をティックに変換する（1ティック未満は切り上げ、最低1ティック）
+  uint64 ToTicks(double seconds) const {
+    return Max<uint64>(
+      1, static_cast<uint64>(Math::Ceil(seconds / m_tick_seconds)));
+  }
+
+  uint64 GetCurrentTick() const { return m_current_tick; }
+
+  // 現在から指定ティック後に期限を迎えるよう登録し、期限のティックを返す
+  uint64 ScheduleAfter(uint64 id, uint64 ticks) {
+    return ScheduleAt(id, m_current_tick + Max<uint64>(ticks, 1));
+  }
+
+  // 指定したティックに期限を迎えるよう登録する（過去のティックは次のティックに繰り上げる）
+  uint64 ScheduleAt(uint64 id, uint64 due_tick) {
+    due_tick = Max(due_tick, m_current_tick + 1);
+    Insert({id, due_tick});
+    ++m_count;
+    return due_tick;
+  }
+
+  // 時刻をnow_seconds（ホイール作成からの経過秒）まで進め、期限を迎えたIDごとにon_expired(id, due_tick)を呼ぶ
+  // on_expiredの中でScheduleAfter()を呼んで再登録してよい（次のティック以降に入る）
+  template <typename Func>
+  void Advance(double now_seconds, Func&& on_expired) {
+    const uint64 target =
+      static_cast<uint64>(Math::Floor(now_seconds / m_tick_seconds));
+    while (m_current_tick < target) {
+      ++m_current_tick;
+      const uint64 t = m_current_tick;
+
+      // 上位のホイールが一周したら、次の区間の要素を下位へ振り分け直す
+      if ((t & kSlotMask) == 0) {
+        if (((t >> kSlotBits) & kSlotMask) == 0) {
+          if (((t >> (kSlotBits * 2)) & kSlotMask) == 0) {
+            Cascade(m_overflow);
+          }
+          Cascade(m_wheels[2][(t >> (kSlotBits * 2)) & kSlotMask]);
+        }
+        Cascade(m_wheels[1][(t >> kSlotBits) & kSlotMask]);
+      }
+
+      // 走査中に同じスロットへ追加されないよう、取り出してから通知する
+      std::vector<Entry>& slot = m_wheels[0][t & kSlotMask];
+      if (slot.empty()) {
+        continue;
+      }
+      m_expired.swap(slot);
+      m_count -= m_expired.size();
+      for (const Entry& entry : m_expired) {
+        on_expired(entry.id, entry.due_tick);
+      }
+      m_expired.clear();
+    }
+  }
+
+  // 登録されている数（取り出していない古い登録も含む）
+  size_t GetCount() const { return m_count; }
+
+  private:
+  struct Entry {
+    uint64 id;
+    uint64 due_tick;
+  };
+
+  static constexpr uint32 kSlotBits = 8;
+  static constexpr uint64 kSlots = 1ull << kSlotBits;
+  static constexpr uint64 kSlotMask = kSlots - 1;
+  static constexpr size_t kLevels = 3;
+
+  // 期限までの距離に応じて、入れるホイールとスロットを決める
+  void Insert(const Entry& entry) {
+    const uint64 delta = entry.due_tick - m_current_tick;
+    if (delta < kSlots) {
+      m_wheels[0][entry.due_tick & kSlotMask].push_back(entry);
+    } else if (delta < (kSlots << kSlotBits)) {
+      m_wheels[1][(entry.due_tick >> kSlotBits) & kSlotMask].push_back(entry);
+    } else if (delta < (kSlots << (kSlotBits * 2))) {
+      m_wheels[2][(entry.due_tick >> (kSlotBits * 2)) & kSlotMask].push_back(
+        entry);
+    } else {
+      m_overflow.push_back(entry);
+    }
+  }
+
+  void Cascade(std::vector<Entry>& slot) {
+    if (slot.empty()) {
+      return;
+    }
+    m_cascade.swap(slot);
+    for (const Entry& entry : m_cascade) {
+      Insert(entry);
+    }
+    m_cascade.clear();
+  }
+
+  double m_tick_seconds;
+  uint64 m_current_tick = 0;
+  size_t m_count = 0;
+  std::array<std::array<std::vector<Entry>, kSlots>, kLevels> m_wheels;
+  std::vector<Entry> m_overflow;
+  // 容量を使い回すための作業用配列
+  std::vector<Entry> m_expired;
+  std::vector<Entry> m_cascade;
+};
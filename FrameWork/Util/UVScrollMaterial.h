@@ -0,0 +1,53 @@
+﻿#pragma once
+#include <Siv3D.hpp>
+
+// uv_scroll.hlslのVSUVScrollと一致させる（定数バッファは16バイト単位）
+struct UVScrollCB {
+  Float2 offset = Float2::Zero();
+  Float2 unused = Float2::Zero();
+};
+
+// テクスチャのUVを定数バッファのオフセットでずらして描画するマテリアル
+// メッシュは一度作ったものを使い回し、毎フレーム変わるのは16バイトの定数バッファだけ
+//   UVScrollMaterial material;
+//   material.SetOffset(Float2{t, 0});
+//   material.Draw(mesh, texture);
+// シェーダーの読み込みに失敗した場合はスクロールせずに描画する
+class UVScrollMaterial {
+  public:
+  static constexpr StringView kShaderPath = U"Asset/shader/uv_scroll.hlsl";
+
+  UVScrollMaterial() : m_vs{HLSL{kShaderPath, U"VS"}} {
+    if (!m_vs) {
+      s3d::Console << U"UVScrollMaterial: シェーダーの読み込みに失敗しました";
+    }
+  }
+
+  bool IsShaderValid() const { return static_cast<bool>(m_vs); }
+
+  // 長時間スクロールしてもfloatの精度が落ちないよう、オフセットは[0, 2)に丸めて保持する
+  // 周期2はリピートとミラーのどちらのサンプラーでも見た目が変わらない
+  void SetOffset(const Vec2& offset) {
+    m_cb->offset = Float2{WrapPeriod(offset.x), WrapPeriod(offset.y)};
+  }
+
+  Float2 GetOffset() const { return m_cb->offset; }
+
+  // サンプラーはリピートかミラーにしておくこと
+  void Draw(const Mesh& mesh, const Texture& texture) const {
+    if (!m_vs) {
+      mesh.draw(texture);
+      return;
+    }
+    Graphics3D::SetVSConstantBuffer(4, m_cb);
+    const ScopedCustomShader3D shader{m_vs};
+    mesh.draw(texture);
+  }
+
+  private:
+  // Math::Fmodは負の値を(-2, 0]に丸めるため、床関数で[0, 2)に収める
+  static double WrapPeriod(double x) { return x - 2.0 * Math::Floor(x / 2.0); }
+
+  VertexShader m_vs;
+  ConstantBuffer<UVScrollCB> m_cb;
+};
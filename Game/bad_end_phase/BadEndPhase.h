@@ -7,6 +7,8 @@
 #include "Game/base_system/MessageWindowUI.h"
 #include "Game/base_system/SisterMessageUI.h"
 #include "Game/base_system/SisterMessageUIManager.h"
+#include "Game/utility/GameClock.h"
+#include "Game/utility/GameInput.h"
 #include "Game/utility/SoundManager.h"
 #include "Game/utility/iPhase.h"
 
@@ -94,7 +96,7 @@ class BadEndPhase : public iPhase {
 
       case State::ShowingNotification:
         // マウス左クリックで次の状態へ遷移
-        if (MouseL.down()) {
+        if (GameInput::LeftDown()) {
           auto sisterUI = SisterMessageUIManager::GetSisterMessageUI().lock();
           if (sisterUI) {
             ShowCurtainMessage();
@@ -166,6 +168,6 @@ class BadEndPhase : public iPhase {
 
   // データメンバ
   State currentState_ = State::NotificationInterval;  // 現在の状態
-  Stopwatch inputTimer_;                             // コンストラクタ後の入力間隔タイマー
-  Stopwatch endTimer_;                               // END 表示までの待機タイマー
+  Stopwatch inputTimer_{StartImmediately::No, GameClock::GetSteadyClock()};  // コンストラクタ後の入力間隔タイマー
+  Stopwatch endTimer_{StartImmediately::No, GameClock::GetSteadyClock()};    // END 表示までの待機タイマー
 };
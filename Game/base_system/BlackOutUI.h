@@ -2,6 +2,7 @@
 #pragma once
 #include <Siv3D.hpp>
 #include "Game/utility/FontManager.h"
+#include "Game/utility/GameClock.h"
 
 // 暗転処理と暗転時に表示するメッセージを管理するクラス
 // モノステートパターンで実装され、どこからでもアクセス可能
@@ -148,7 +149,7 @@ class BlackOutUI {
   static inline double fadeAlpha_ = 0.0;   // フェードのアルファ値（0.0～1.0）
   static inline State state_ = State::Hidden;  // 現在の状態
   static inline double fadeDuration_ = kDefaultFadeDuration;  // フェードの所要時間（秒）
-  static inline Stopwatch fadeTimer_;      // フェードタイマー
+  static inline Stopwatch fadeTimer_{StartImmediately::No, GameClock::GetSteadyClock()};  // フェードタイマー
   // 実行時に変更可能なテキスト色（デフォルトは kTextColor）
   static inline ColorF textColor_ = kTextColor;
 };
@@ -6,10 +6,13 @@
 #include "Game/base_system/PhaseManager.h"
 #include "Game/base_system/GameCommonData.h"
 #include "Game/utility/FontManager.h"
+#include "Util/FramePacer.h"
+#include "Util/FrameProfiler.h"
 
 // デバッグ表示を行う静的ユーティリティクラス
 // - F1 キーで表示/非表示を切り替え
 // - FPS とマウス座標を左上に表示する
+// - 表示中は FrameProfiler で処理ごとの時間を計測し、右上に表示する（F9 でトレースを書き出す）
 class DebugSystem {
   public:
   // 毎フレームの更新処理
@@ -18,11 +21,17 @@ class DebugSystem {
     if (KeyF10.down()) {
       s_enabled = !s_enabled;
     }
+    FrameProfiler::SetEnabled(s_enabled);
 
     if (!s_enabled) {
       return;
     }
 
+    // chrome://tracing や Perfetto で開けるトレースを書き出す
+    if (KeyF9.down()) {
+      FrameProfiler::ExportChromeTrace(U"profile_trace.json");
+    }
+
     // 表示用データを更新
     s_fps = Profiler::FPS();
     s_mousePos = Cursor::PosF();
@@ -36,7 +45,7 @@ class DebugSystem {
 
   // 情報表示用の半透明矩形（左下に表示）
   const int infoBgW = static_cast<int>(Scene::Width() * 0.4); // 画面幅の40%を目安
-  const int infoBgH = 96; // 高さを広めにしてフェーズ名の切れを防ぐ
+  const int infoBgH = 116; // 高さを広めにしてフェーズ名の切れを防ぐ
   const int margin = 8;
   const int infoX = margin;  // 左端から少し内側に寄せる
   const int infoY = static_cast<int>(Scene::Height()) - infoBgH;
@@ -57,7 +66,10 @@ class DebugSystem {
   // 日付と精神力を追加表示
   const String currentDate = GameCommonData::GetCurrentDateString();
   const int32 currentMental = GameCommonData::GetMentalPower();
+  const FramePacer::Stats pacing = FramePacer::GetStats();
   const String info = U"FPS: " + Format(s_fps)
+            + U"\nJitter: σ{:.2f} p99 {:.2f} max {:.2f} ms / skip {}"_fmt(
+                pacing.stddev_ms, pacing.p99_error_ms, pacing.max_error_ms, pacing.skipped)
             + U"\nMouse: " + Format(s_mousePos.x) + U", " + Format(s_mousePos.y)
             + U"\nPhase: " + phaseName
             + U"\nDate: " + currentDate
@@ -66,6 +78,11 @@ class DebugSystem {
   // 情報は左下（infoBg の内側）に描画
   font(info).draw(infoX + margin, infoY + margin, Palette::White);
 
+  // 処理ごとの時間（フレームグラフと p50/p99）を右上に表示
+  constexpr double profilerW = 480.0;
+  FrameProfiler::DrawOverlay(
+    font, Vec2(Scene::Width() - profilerW - 16.0 - margin, margin), profilerW);
+
     // デバッグ用ボタン（SimpleGUI を使用）：暗転解除 / 次フェーズへ
     // ボタン群を btnBg の内側で横方向中央揃えに配置
     const double buttonW = 140.0;
@@ -7,11 +7,13 @@
 #include "BlackOutUI.h"
 #include "CommonUI.h"
 #include "Game/utility/FontManager.h"
+#include "Game/utility/GameClock.h"
 #include "Game/utility/GameConst.h"
 #include "Game/utility/MouseEffectManager.h"
 #include "Game/utility/PhaseType.h"
 #include "Game/utility/SoundManager.h"
 #include "GameCommonData.h"
+#include "LlmPrefetchPlanner.h"
 #include "MessageWindowUI.h"
 #include "PhaseManager.h"
 #include "SisterMessageUIManager.h"
@@ -61,11 +63,25 @@ class GameManager {
     // 各PhaseTypeに対応する生成関数を登録
     RegisterPhaseFactories();
 
+    // 求職活動フェーズで使うLLMコンテキストを事前確保（フェーズ開始時の確保を避ける）
+    JobSearchPhase::PrewarmLlmContext();
+
+    // フェーズ遷移に合わせて次のLLMフェーズのプロンプトを先読みする
+    LlmPrefetchPlanner::Initialize();
+
     // 初期フェーズを設定（IntroductionPhase）
     PhaseManager::ChangePhase(GameConst::kInitialPhase);
   }
 
+  // 作業フェーズの部品の流し方を設定する（Initialize()の前に呼ぶ）
+  // 通常のプレイはClassicのまま。ECS版コンベアの計測やデバッグのときだけ Main の --ecs-conveyor で切り替える
+  static void SetWorkConveyorMode(WorkPhase::ConveyorMode mode) {
+    s_workConveyorMode = mode;
+  }
+
   private:
+  inline static WorkPhase::ConveyorMode s_workConveyorMode = WorkPhase::ConveyorMode::Classic;
+
   // 各PhaseTypeに対応する生成関数を登録
   static void RegisterPhaseFactories() {
     PhaseManager::RegisterPhaseFactory(PhaseType::Introduction, []() {
@@ -81,7 +97,7 @@ class GameManager {
       return std::make_shared<SisterMessagePhase>();
     });
     PhaseManager::RegisterPhaseFactory(PhaseType::Work, []() {
-      return std::make_shared<WorkPhase>();
+      return std::make_shared<WorkPhase>(s_workConveyorMode);
     });
     PhaseManager::RegisterPhaseFactory(PhaseType::Sunset, []() {
       return std::make_shared<SunsetPhase>();
@@ -110,7 +126,7 @@ class GameManager {
     MouseEffectManager::Update();
 
     // サウンドマネージャーの更新（クロスフェード処理のため必須）
-    SoundManager::Update(Scene::DeltaTime());
+    SoundManager::Update(GameClock::DeltaTime());
 
     // 共通UIの更新
     BlackOutUI::Update();
@@ -0,0 +1,218 @@
+﻿// HeadlessRunner.h
+#pragma once
+#include <Siv3D.hpp>
+#include <algorithm>
+#include <chrono>
+
+#include "FrameWork/LlamaCpp/LlamaReplay.h"
+#include "FrameWork/Util/AllocationCounter.h"
+#include "Game/base_system/GameCommonData.h"
+#include "Game/base_system/GameManager.h"
+#include "Game/base_system/HeadlessScript.h"
+#include "Game/base_system/PhaseManager.h"
+#include "Game/utility/GameClock.h"
+#include "Game/utility/GameInput.h"
+#include "Game/utility/PhaseType.h"
+
+// 描画を行わずにGameManager::Update()だけを最大速度で回し、スクリプトの入力でゲームを通しでプレイするクラス
+// 時間はGameClockの仮想時間で固定幅ずつ進め、LLMの応答はLlamaReplayの記録から再生する
+// 回帰テストと性能計測に使い、フェーズごとのフレーム時間とヒープ確保量をコンソール（と任意でファイル）に出力する
+// GameManager::Initialize()は内部で呼ぶため、ウィンドウの設定後にGameManagerを初期化せずに呼ぶ
+//   HeadlessRunner::Config config;
+//   config.llm_replay_path = U"LlmReplay/playthrough.json";
+//   HeadlessRunner::Run(config, HeadlessScript::DefaultPlaythrough());
+class HeadlessRunner {
+  public:
+  HeadlessRunner() = delete;
+
+  struct Config {
+    double delta_time = 1.0 / 60.0;       // 1フレームで進める仮想時間（秒）
+    int64 max_frames = 60 * 60 * 30;      // これを超えたら打ち切る（仮想時間で30分）
+    double ending_seconds = 20.0;         // 結末のフェーズに入ってから終了するまでの仮想時間（秒）
+    uint64 random_seed = 20250101;        // 乱数のシード（同じシードなら同じ結果になる）
+    FilePath llm_replay_path;             // LLMの応答の記録ファイル（空なら実際に生成する）
+    FilePath report_path;                 // 結果の出力先（空ならコンソールのみ）
+  };
+
+  // 結末のフェーズに到達したらtrueを返す
+  // フレーム数の上限に達した場合やウィンドウが閉じられた場合はfalseを返す
+  static bool Run(const Config& config, const HeadlessScript& script) {
+    // Stopwatchが仮想時間を使い始める前に切り替える
+    GameClock::EnableVirtualTime();
+    GameInput::SetScripted(true);
+    Reseed(config.random_seed);
+    GlobalAudio::SetVolume(0.0);
+
+    if (!config.llm_replay_path.isEmpty() && !llama_cpp::LlamaReplay::LoadReplay(config.llm_replay_path)) {
+      return false;
+    }
+
+    GameManager::Initialize();
+
+    HashTable<PhaseType, PhaseStats> stats;
+    Array<PhaseType> visitOrder;
+    PhaseType phaseType = PhaseManager::GetCurrentPhaseType();
+    PhaseCursor cursor;
+    EnterPhase(phaseType, script, stats, visitOrder, cursor);
+
+    using Clock = std::chrono::steady_clock;
+    const auto wallStart = Clock::now();
+    auto lastPump = wallStart;
+    const double gameStart = GameClock::Time();
+
+    bool reachedEnding = false;
+    bool aborted = false;
+    int64 frames = 0;
+    while (frames < config.max_frames) {
+      if (PhaseManager::GetCurrentPhaseType() != phaseType) {
+        phaseType = PhaseManager::GetCurrentPhaseType();
+        EnterPhase(phaseType, script, stats, visitOrder, cursor);
+      }
+
+      GameInput::SetFrame(NextInput(script.FindPhaseInput(phaseType), cursor));
+
+      const auto before = AllocationCounter::GetThreadSnapshot();
+      const auto updateStart = Clock::now();
+      GameManager::Update();
+      const double updateMs = std::chrono::duration<double, std::milli>(Clock::now() - updateStart).count();
+      const auto allocated = AllocationCounter::GetThreadSnapshot() - before;
+
+      // フレーム中にフェーズが切り替わっても、開始時のフェーズに計上する
+      PhaseStats& phaseStats = stats[phaseType];
+      ++phaseStats.frames;
+      phaseStats.game_seconds += config.delta_time;
+      phaseStats.frame_ms << updateMs;
+      phaseStats.alloc_count += allocated.count;
+      phaseStats.alloc_bytes += allocated.bytes;
+
+      GameClock::Advance(config.delta_time);
+      ++frames;
+
+      // ウィンドウが応答なしにならないよう、実時間で一定間隔ごとにだけSystem::Update()を呼ぶ
+      const auto now = Clock::now();
+      if (now - lastPump >= kPumpInterval) {
+        lastPump = now;
+        if (!System::Update()) {
+          aborted = true;
+          break;
+        }
+      }
+
+      if (IsEndingPhase(phaseType) && GameClock::Time() - cursor.enter_time >= config.ending_seconds) {
+        reachedEnding = true;
+        break;
+      }
+    }
+
+    const double wallSeconds = std::chrono::duration<double>(Clock::now() - wallStart).count();
+    const double gameSeconds = GameClock::Time() - gameStart;
+
+    Array<String> lines;
+    lines << U"=== HeadlessRunner ===";
+    if (reachedEnding) {
+      lines << U"結果: {} (精神力 {})"_fmt(phase_type_util::ToStringView(phaseType), GameCommonData::GetMentalPower());
+    } else if (aborted) {
+      lines << U"結果: 中断 ({})"_fmt(phase_type_util::ToStringView(phaseType));
+    } else {
+      lines << U"結果: {}フレームで打ち切り ({})"_fmt(config.max_frames, phase_type_util::ToStringView(phaseType));
+    }
+    lines << U"{} frames, ゲーム内 {:.1f}s, 実時間 {:.2f}s (x{:.1f})"_fmt(
+      frames, gameSeconds, wallSeconds, (wallSeconds > 0.0) ? gameSeconds / wallSeconds : 0.0);
+    lines << U"phase          visits  frames   game[s]  mean[ms]  p99[ms]  max[ms]  alloc/frame  KB/frame";
+    for (const PhaseType type : visitOrder) {
+      lines << FormatStats(type, stats[type]);
+    }
+    if (!AllocationCounter::kIsEnabled) {
+      lines << U"※ alloc/frame と KB/frame は ENABLE_ALLOCATION_COUNTER を定義したビルドでのみ計測される";
+    }
+
+    for (const auto& line : lines) {
+      Console << line;
+    }
+    if (!config.report_path.isEmpty()) {
+      WriteReport(config.report_path, lines);
+    }
+
+    GameInput::SetScripted(false);
+    return reachedEnding;
+  }
+
+  private:
+  static constexpr auto kPumpInterval = std::chrono::milliseconds{250};  // System::Update()を呼ぶ実時間の間隔
+
+  // フェーズごとの集計
+  struct PhaseStats {
+    int32 visits = 0;          // フェーズに入った回数
+    int64 frames = 0;          // 更新したフレーム数
+    double game_seconds = 0.0; // 経過した仮想時間（秒）
+    Array<double> frame_ms;    // GameManager::Update()の所要時間（ミリ秒）
+    uint64 alloc_count = 0;    // ヒープ確保回数（メインスレッドのみ）
+    uint64 alloc_bytes = 0;    // ヒープ確保バイト数（メインスレッドのみ）
+  };
+
+  // 現在のフェーズに対する入力の進み具合
+  struct PhaseCursor {
+    double enter_time = 0.0;  // フェーズに入った仮想時刻
+    double next_click = 0.0;  // 次にクリックする仮想時刻
+    size_t click_index = 0;   // 次に使うクリック位置
+    Point cursor_pos{0, 0};   // 最後にクリックした位置（カーソルはそこに留まる）
+  };
+
+  [[nodiscard]] static bool IsEndingPhase(PhaseType phaseType) noexcept {
+    return phaseType == PhaseType::GameOver || phaseType == PhaseType::BadEnd ||
+           phaseType == PhaseType::GameClear;
+  }
+
+  // フェーズに入ったときに入力をやり直す
+  static void EnterPhase(PhaseType phaseType, const HeadlessScript& script,
+                         HashTable<PhaseType, PhaseStats>& stats, Array<PhaseType>& visitOrder,
+                         PhaseCursor& cursor) {
+    PhaseStats& phaseStats = stats[phaseType];
+    if (phaseStats.visits++ == 0) {
+      visitOrder << phaseType;
+    }
+
+    const HeadlessPhaseInput* input = script.FindPhaseInput(phaseType);
+    GameInput::SetSubmittedTexts(input ? input->texts : Array<String>{});
+
+    cursor.enter_time = GameClock::Time();
+    cursor.next_click = cursor.enter_time;
+    cursor.click_index = 0;
+  }
+
+  // このフレームの入力を作る（クリック間隔が来ていればクリック位置を1つ進める）
+  [[nodiscard]] static GameInput::Frame NextInput(const HeadlessPhaseInput* input, PhaseCursor& cursor) {
+    GameInput::Frame frame;
+    if (input && !input->click_points.isEmpty() && GameClock::Time() >= cursor.next_click) {
+      cursor.cursor_pos = input->click_points[cursor.click_index % input->click_points.size()];
+      ++cursor.click_index;
+      cursor.next_click = GameClock::Time() + input->click_interval;
+      frame.left_down = true;
+    }
+    frame.cursor_pos = cursor.cursor_pos;
+    return frame;
+  }
+
+  [[nodiscard]] static String FormatStats(PhaseType phaseType, const PhaseStats& phaseStats) {
+    Array<double> sorted = phaseStats.frame_ms;
+    std::sort(sorted.begin(), sorted.end());
+    const double mean = sorted.isEmpty() ? 0.0 : sorted.sum() / sorted.size();
+    const double p99 = sorted.isEmpty() ? 0.0 : sorted[Min(sorted.size() - 1, sorted.size() * 99 / 100)];
+    const double max = sorted.isEmpty() ? 0.0 : sorted.back();
+    const double frames = static_cast<double>(Max<int64>(phaseStats.frames, 1));
+    return U"{:<14} {:>6}  {:>6}  {:>8.1f}  {:>8.3f}  {:>7.3f}  {:>7.3f}  {:>11.1f}  {:>8.2f}"_fmt(
+      phase_type_util::ToStringView(phaseType), phaseStats.visits, phaseStats.frames, phaseStats.game_seconds, mean,
+      p99, max, phaseStats.alloc_count / frames, phaseStats.alloc_bytes / frames / 1024.0);
+  }
+
+  static void WriteReport(const FilePath& path, const Array<String>& lines) {
+    TextWriter writer{path};
+    if (!writer) {
+      Console << U"HeadlessRunner: レポートを書き出せません: " << path;
+      return;
+    }
+    for (const auto& line : lines) {
+      writer.writeln(line);
+    }
+  }
+};
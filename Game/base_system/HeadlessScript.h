@@ -0,0 +1,95 @@
+﻿// HeadlessScript.h
+#pragma once
+#include <Siv3D.hpp>
+
+#include "Game/job_search_phase/RejectionListUI.h"
+#include "Game/job_search_phase/ResumeUI.h"
+#include "Game/utility/ConfirmDialog.h"
+#include "Game/utility/GameConst.h"
+#include "Game/utility/PhaseType.h"
+#include "Game/work_phase/HexBolt.h"
+#include "Game/work_phase/MachineParts.h"
+#include "Game/work_phase/WorkPhase.h"
+
+// ヘッドレス実行でフェーズごとに与える入力
+// - click_points: クリックする位置（クリックするたびに先頭から順に使い、末尾まで使ったら先頭に戻る）
+// - click_interval: クリックの間隔（秒、0なら毎フレーム）
+// - texts: フェーズに入ったときに入力欄へ送るテキスト（受け付けられる状態になったUIが先頭から取り出す）
+struct HeadlessPhaseInput {
+  Array<Point> click_points;
+  double click_interval = 0.5;
+  Array<String> texts;
+};
+
+// HeadlessRunnerに与えるプレイ手順
+// フェーズの種類ごとに入力を登録し、フェーズに入るたびに同じ入力を最初から与える
+class HeadlessScript {
+  public:
+  // フェーズの入力を登録する（登録済みなら置き換える）
+  void SetPhaseInput(PhaseType phaseType, HeadlessPhaseInput input) {
+    inputs_[phaseType] = std::move(input);
+  }
+
+  // フェーズの入力を取得する（未登録ならnullptr）
+  [[nodiscard]] const HeadlessPhaseInput* FindPhaseInput(PhaseType phaseType) const {
+    const auto it = inputs_.find(phaseType);
+    return (it != inputs_.end()) ? &it->second : nullptr;
+  }
+
+  // 3日間を通しでプレイする標準の手順
+  // メッセージは画面中央のクリックで送り、求職活動では自己PRを入力して各ダイアログの「はい」を押す
+  // アルバイトではベルト上の格子点を毎フレーム1点ずつクリックして、流れてくるボルトを締める
+  // 結末はLLMの応答（記録済みの評価点）で決まる
+  // WorkPhaseのカメラを使うため、ウィンドウサイズを決めた後に呼ぶ
+  [[nodiscard]] static HeadlessScript DefaultPlaythrough() {
+    const Point center = GameConst::kPlayAreaCenter.asPoint();
+
+    HeadlessScript script;
+    const HeadlessPhaseInput messageInput{{center}, 0.5, {}};
+    for (const PhaseType phaseType : {PhaseType::Introduction, PhaseType::Sunrise, PhaseType::Sunset,
+                                      PhaseType::NightDream, PhaseType::GameOver, PhaseType::BadEnd,
+                                      PhaseType::GameClear}) {
+      script.SetPhaseInput(phaseType, messageInput);
+    }
+
+    // 不採用リストのダイアログは「はい」のみ、履歴書の提出確認は「はい/いいえ」
+    const Point rejectionYes =
+      ConfirmDialog::GetYesButtonRect(RejectionListUI::kListCenterPos, true).center().asPoint();
+    const Point resumeYes =
+      ConfirmDialog::GetYesButtonRect(ResumeUI::kResumeCenterPos, false).center().asPoint();
+    script.SetPhaseInput(PhaseType::JobSearch,
+                         {{center, rejectionYes, resumeYes},
+                          0.5,
+                          {U"前職では工場のラインで5年間働き、不良品の削減に取り組みました。"}});
+
+    script.SetPhaseInput(PhaseType::SisterMessage, {{center}, 0.5, {U"ただいま"}});
+
+    script.SetPhaseInput(PhaseType::Work, {CreateBeltClickPoints(center), 0.0, {}});
+
+    return script;
+  }
+
+  private:
+  // ボルトの通り道を覆う格子点を画面座標に投影する
+  // クリック判定の球（半径HexBolt::kClickRadius）が隙間なく並ぶよう、奥行き方向は半径より狭い間隔で置く
+  // 部品は左から流れてくるため、ベルトの中央付近の2列で待ち構える
+  // 先頭はメッセージ送り用の画面中央
+  static Array<Point> CreateBeltClickPoints(const Point& center) {
+    const BasicCamera3D camera{Scene::Size(), WorkPhase::kCameraFOV, WorkPhase::kCameraPos,
+                               WorkPhase::kCameraTarget};
+    const double boltY = MachineParts::kBodySize.y / 2 + HexBolt::kBoltHeight / 2;
+    const double maxZ = (MachineParts::kBodySize.z - HexBolt::kBoltRadius * 2) / 2;
+    const double stepZ = HexBolt::kClickRadius * 1.5;
+
+    Array<Point> points{center};
+    for (const double x : {-150.0, 0.0}) {
+      for (double z = -maxZ; z <= maxZ + stepZ / 2; z += stepZ) {
+        const Vec3 pos{x, boltY, Min(z, maxZ)};
+        points << camera.worldToScreenPoint(Float3{pos}).xy().asPoint();
+      }
+    }
+    return points;
+  }
+
+  HashTable<PhaseType, HeadlessPhaseInput> inputs_;  // フェーズごとの入力
+};
@@ -0,0 +1,57 @@
+﻿// LlmPrefetchPlanner.h
+#pragma once
+#include <Siv3D.hpp>
+#include <memory>
+
+#include "FrameWork/LlamaCpp/LlamaPrefetchScheduler.h"
+#include "FrameWork/LlamaCpp/LlamaTextGenerator.h"
+#include "Game/base_system/PhaseManager.h"
+#include "Game/base_system/SisterMessageUIManager.h"
+#include "Game/job_search_phase/JobSearchPhase.h"
+#include "Game/utility/PhaseType.h"
+
+// フェーズ遷移を監視し、次に来そうなLLMフェーズのシステムプロンプトを先読み（プリフィル）する静的クラス
+// 先読みはLlamaPrefetchSchedulerのワーカースレッドで行い、対話的な生成が始まると中断して譲る
+class LlmPrefetchPlanner {
+  public:
+  LlmPrefetchPlanner() = delete;
+
+  // PhaseManagerのフェーズ変更通知に登録する
+  // PhaseManager::Initialize()の後、最初のChangePhase()の前に呼ぶ
+  static void Initialize() {
+    PhaseManager::SetOnPhaseChanged([](PhaseType phaseType) { OnPhaseChanged(phaseType); });
+  }
+
+  private:
+  // フェーズ変更時の処理
+  // 1つ先のフェーズがLLMを使う場合に、そのジェネレーターのプリフィルを予約する
+  static void OnPhaseChanged(PhaseType phaseType) {
+    switch (phase_type_util::GetLikelyNextPhase(phaseType)) {
+    case PhaseType::JobSearch:
+      // ジェネレーターの作成はメインスレッドで行い（プールから取得するだけなので軽い）、
+      // 重いプロンプトのデコードのみワーカーに任せる
+      EnqueuePrefill(U"job_search", JobSearchPhase::PrepareLlamaTextGenerator());
+      break;
+    case PhaseType::SisterMessage:
+      if (auto sisterMessageUI = SisterMessageUIManager::GetSisterMessageUI().lock()) {
+        EnqueuePrefill(U"sister_message", sisterMessageUI->GetLlmGenerator());
+      }
+      break;
+    default:
+      break;
+    }
+  }
+
+  // ジェネレーターのプリフィルをスケジューラーに登録する
+  static void EnqueuePrefill(const String& key, std::shared_ptr<llama_cpp::LlamaTextGenerator> generator) {
+    if (!generator) {
+      return;
+    }
+
+    llama_cpp::LlamaPrefetchScheduler::GetInstance().Enqueue(key, [generator]() {
+      return generator->Prefill([]() {
+        return llama_cpp::LlamaPrefetchScheduler::GetInstance().ShouldYield();
+      });
+    });
+  }
+};
@@ -3,6 +3,8 @@
 #include <Siv3D.hpp>
 
 #include "Game/utility/FontManager.h"
+#include "Game/utility/GameClock.h"
+#include "Game/utility/GameInput.h"
 
 // メッセージウィンドウの描画と管理を行うクラス
 // モノステートパターンで実装され、どこからでもアクセス可能
@@ -90,7 +92,7 @@ class MessageWindowUI {
 
     if (clickToAdvance_) {
       // クリックで次へ進む処理
-      if (MouseL.down()) {
+      if (GameInput::LeftDown()) {
         Next();
         return;
       }
@@ -182,7 +184,7 @@ class MessageWindowUI {
   static inline bool isVisible_ = false;               // 表示中かどうか
   static inline RectF windowRect_;                     // ウィンドウの矩形（画面下1/3）
   static inline int32 currentCharIndex_ = 0;           // 現在表示中の文字インデックス
-  static inline Stopwatch charTimer_;                  // 文字表示用タイマー
+  static inline Stopwatch charTimer_{StartImmediately::No, GameClock::GetSteadyClock()};  // 文字表示用タイマー
   static inline ColorF textColor_ = kTextColor;        // テキストの色（デフォルトは白色）
   static inline bool clickToAdvance_ = true;            // クリックで次へ進むかどうか
 };
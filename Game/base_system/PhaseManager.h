@@ -3,6 +3,7 @@
 
 #include "Game/utility/PhaseType.h"
 #include "Game/utility/iPhase.h"
+#include "Util/FrameProfiler.h"
 
 // PhaseManagerクラス
 // フェーズの管理と切り替えを行う
@@ -14,11 +15,20 @@ class PhaseManager {
   // Phase生成関数の型定義
   using PhaseFactory = std::function<std::shared_ptr<iPhase>()>;
 
+  // フェーズ変更通知の型定義（変更後のPhaseTypeを受け取る）
+  using PhaseChangedCallback = std::function<void(PhaseType)>;
+
   // 初期化（Phase生成関数を登録）
   static void Initialize() {
     phaseFactories_.clear();
     currentPhase_.reset();
     currentPhaseType_ = PhaseType::Introduction;
+    onPhaseChanged_ = nullptr;
+  }
+
+  // フェーズ変更時に呼ばれるコールバックを設定（次フェーズの先読みなどに使う）
+  static void SetOnPhaseChanged(PhaseChangedCallback callback) {
+    onPhaseChanged_ = std::move(callback);
   }
 
   // Phase生成関数を登録
@@ -29,6 +39,7 @@ class PhaseManager {
   // 更新処理
   static void Update() {
     if (currentPhase_) {
+      const FrameProfiler::Scope scope{"iPhase::update"};
       currentPhase_->update();
     }
   }
@@ -36,6 +47,7 @@ class PhaseManager {
   // 描画処理
   static void Draw() {
     if (currentPhase_) {
+      const FrameProfiler::Scope scope{"iPhase::draw"};
       currentPhase_->draw();
     }
   }
@@ -55,6 +67,10 @@ class PhaseManager {
       currentPhase_ = it->second();
       // 現在のフェーズ種別を更新
       currentPhaseType_ = phaseType;
+      // 変更を通知
+      if (onPhaseChanged_) {
+        onPhaseChanged_(phaseType);
+      }
     } else {
       // 登録されていない場合はエラー
       Console << U"PhaseManager::ChangePhase - 未登録のPhaseType: " << static_cast<int32>(phaseType);
@@ -84,4 +100,5 @@ class PhaseManager {
   static inline std::shared_ptr<iPhase> currentPhase_;                  // 現在のフェーズ
   static inline PhaseType currentPhaseType_ = PhaseType::Introduction;  // 現在のフェーズ種別
   static inline HashTable<PhaseType, PhaseFactory> phaseFactories_;     // PhaseType毎の生成関数
+  static inline PhaseChangedCallback onPhaseChanged_;                   // フェーズ変更時のコールバック
 };
@@ -3,10 +3,12 @@
 #include <Siv3D.hpp>
 
 #include "FrameWork/LlamaCpp/LlamaModel.h"
+#include "FrameWork/LlamaCpp/LlamaReplay.h"
 #include "FrameWork/UI/ChatMessageWindow.h"
 #include "Game/llm_chat/LlmChatWindow.h"
 #include "Game/utility/FontManager.h"
 #include "Game/utility/GameConst.h"
+#include "Game/utility/GameInput.h"
 #include "Game/utility/UiConst.h"
 
 // TODO:妹の返信待ちの時間に既読や、入力中...の表示を追加する
@@ -44,12 +46,14 @@ class SisterMessageUI {
     U"あなたは100文字以内の日本語で返答します。\n";
 
   // コンストラクタ: メンバ変数の初期化を行う
+  // LLMの応答を再生している場合はモデルなしで初期化する
   SisterMessageUI() {
     auto& model_manager = llama_cpp::LlamaModelManager::GetInstance();
     auto shared_model = model_manager.GetModel(String(GameConst::kLlmModelId));
+    const bool is_replaying = llama_cpp::LlamaReplay::IsReplaying();
 
-    assert(shared_model && "LlamaModelの取得に失敗しました。モデルが初期化されていることを確認してください。");
-    if (shared_model) {
+    assert((shared_model || is_replaying) && "LlamaModelの取得に失敗しました。モデルが初期化されていることを確認してください。");
+    if (shared_model || is_replaying) {
       Initialize(shared_model);
     }
 
@@ -61,6 +65,7 @@ class SisterMessageUI {
 
   // LLMモデルを取得し、kSisterSystemPromptを使ってLlmChatWindowを初期化する
   // 成功時はtrue、失敗時はfalseを返す
+  // modelがnullptrの場合はジェネレータを作らない（LLMの応答を再生するときのみ成功扱い）
   // SisterMessageUIManager::Initialize()の後に呼ばれる想定
   bool Initialize(std::shared_ptr<llama_cpp::LlamaModel> model) {
     // LlmChatWindowDescを構築
@@ -82,10 +87,15 @@ class SisterMessageUI {
     llm_desc.setting.input_area_height = 40.0;
     llm_desc.setting.system_prompt = kSisterSystemPrompt;
     llm_desc.setting.max_input_char = 40;
+    llm_desc.setting.replay_channel = U"sister_message";
 
     // LlmChatWindowを生成
     llmChatWindow_ = std::make_unique<LlmChatWindow>(llm_desc);
 
+    if (!model) {
+      return llama_cpp::LlamaReplay::IsReplaying();
+    }
+
     // LlmChatWindowの初期化
     if (!llmChatWindow_->Initialize(model)) {
       return false;
@@ -96,8 +106,20 @@ class SisterMessageUI {
 
   // 毎フレーム呼ばれる更新処理
   // SisterMessageUIManager::Update()から呼ばれる
+  // MEMO: 入力欄の処理はDrawで行うため、ここでは描画を伴わない処理だけを行う
+  //       （ヘッドレス実行ではDrawが呼ばれないため、応答の監視とスクリプト入力の送信をここで行う）
   void Update() {
-    // MEMO: 更新処理はDrawで呼び出すため空
+    if (!isActive_ || !llmChatWindow_) {
+      return;
+    }
+
+    llmChatWindow_->UpdateResponse();
+
+    if (!llmChatWindow_->IsInputAreaDisabled() && !llmChatWindow_->IsWaitingForReply()) {
+      if (const auto text = GameInput::TakeSubmittedText()) {
+        llmChatWindow_->Submit(*text);
+      }
+    }
   }
 
   // 毎フレーム呼ばれる描画処理
@@ -200,6 +222,12 @@ class SisterMessageUI {
     return !llmChatWindow_->IsWaitingForReply() && isMessageSent_;
   }
 
+  // 妹の返信に使うテキスト生成器を取得する（未初期化ならnullptr）
+  // LlmPrefetchPlannerがシステムプロンプトのプリフィルに使用する
+  [[nodiscard]] std::shared_ptr<llama_cpp::LlamaTextGenerator> GetLlmGenerator() const {
+    return llmChatWindow_ ? llmChatWindow_->GetGenerator() : nullptr;
+  }
+
   private:
   // 内部で使用するチャットウィンドウ
   std::unique_ptr<LlmChatWindow> llmChatWindow_;
@@ -3,6 +3,7 @@
 #include <Siv3D.hpp>
 #include "Game/base_system/BlackOutUI.h"
 #include "Game/base_system/MessageWindowUI.h"
+#include "Game/utility/GameClock.h"
 #include "Game/utility/iPhase.h"
 
 // ゲームクリア時のエンディングフェーズを管理するクラス
@@ -72,14 +73,14 @@ class GameClearPhase : public iPhase {
         // 暗転完了を確認したら待機状態に移行して遅延を開始
         if (BlackOutUI::IsVisible()) {
           // 現在時刻を記録して待機状態へ
-          fadeCompleteTime_ = Scene::Time();
+          fadeCompleteTime_ = GameClock::Time();
           currentState_ = State::WaitingAfterFade;
         }
         break;
 
       case State::WaitingAfterFade:
         // 指定秒数待ってから GAME CLEAR を表示
-        if ((Scene::Time() - fadeCompleteTime_) >= kEndMessageDelay) {
+        if ((GameClock::Time() - fadeCompleteTime_) >= kEndMessageDelay) {
           currentState_ = State::Finished;
           BlackOutUI::SetMessage(kEndMessage);
         }
@@ -108,6 +109,6 @@ class GameClearPhase : public iPhase {
 
   // データメンバ
   State currentState_ = State::WaitingBeforeMessage;  // 現在の状態
-  Stopwatch initialDelayStopwatch_;                   // メッセージ表示前の待機時間計測用
-  double fadeCompleteTime_ = 0.0;                     // 暗転完了時刻の記録(Scene::Time())
+  Stopwatch initialDelayStopwatch_{StartImmediately::No, GameClock::GetSteadyClock()};  // メッセージ表示前の待機時間計測用
+  double fadeCompleteTime_ = 0.0;                     // 暗転完了時刻の記録(GameClock::Time())
 };
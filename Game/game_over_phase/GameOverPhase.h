@@ -4,6 +4,7 @@
 
 #include "Game/base_system/BlackOutUI.h"
 #include "Game/base_system/MessageWindowUI.h"
+#include "Game/utility/GameClock.h"
 #include "Game/utility/GameConst.h"
 #include "Game/utility/SoundManager.h"
 #include "Game/utility/iPhase.h"
@@ -142,6 +143,6 @@ class GameOverPhase : public iPhase {
   // データメンバ
   State currentState_ = State::ShowingMessage;  // 現在の状態
   bool messageCompleted_ = false;               // メッセージ表示完了フラグ
-  Stopwatch stopWatch_;                         // 暗転完了からの経過時間計測用タイマー
+  Stopwatch stopWatch_{StartImmediately::No, GameClock::GetSteadyClock()};  // 暗転完了からの経過時間計測用タイマー
   Texture redIcon_;                             // Finished 時に表示する赤アイコンのテクスチャ
 };
@@ -4,6 +4,8 @@
 
 #include "Game/base_system/BlackOutUI.h"
 #include "Game/base_system/PhaseManager.h"
+#include "Game/utility/GameClock.h"
+#include "Game/utility/GameInput.h"
 #include "Game/utility/iPhase.h"
 
 // ゲーム開始時の初回のみ実行される導入フェーズを管理するクラス
@@ -49,7 +51,7 @@ class IntroductionPhase : public iPhase {
         break;
       case State::WaitingForInput:
         // 入力待ち状態でクリックされたら次のテキストへ
-        if (MouseL.down()) {
+        if (GameInput::LeftDown()) {
           if (currentTextIndex_ < static_cast<int32>(introductionTexts_.size())) {
             // 次のテキストがあるので表示
             ShowNextText();
@@ -94,7 +96,7 @@ class IntroductionPhase : public iPhase {
     U"すべての企業は、政府中央AI採用システム\n「モノアイ」を通してのみ採用を行えるようになった。"};  // 導入で表示するテキスト配列
   State state_ = State::WaitingForInitialDelay;                                                      // 現在の状態
   int32 currentTextIndex_ = 0;                                                                       // 現在表示中のテキストインデックス
-  Stopwatch displayTimer_;                                                                           // テキスト表示時間計測用タイマー
-  Stopwatch stateTimer_;                                                                             // 状態管理用タイマー
+  Stopwatch displayTimer_{StartImmediately::No, GameClock::GetSteadyClock()};                        // テキスト表示時間計測用タイマー
+  Stopwatch stateTimer_{StartImmediately::No, GameClock::GetSteadyClock()};                          // 状態管理用タイマー
   bool isWaitingForInput_ = false;                                                                   // プレイヤーの入力待ち状態かどうか
 };
@@ -2,8 +2,11 @@
 #pragma once
 #include <Siv3D.hpp>
 #include <memory>
+#include <mutex>
 
+#include "FrameWork/LlamaCpp/LlamaContextPool.h"
 #include "FrameWork/LlamaCpp/LlamaModelManager.h"
+#include "FrameWork/LlamaCpp/LlamaReplay.h"
 #include "FrameWork/LlamaCpp/LlamaTextBuffer.h"
 #include "FrameWork/LlamaCpp/LlamaTextGenerator.h"
 #include "Game/base_system/GameCommonData.h"
@@ -39,9 +42,41 @@ class JobSearchPhase : public iPhase {
   static constexpr int32 kFinalDayPassingScore = 90;       // 最終日の合格ライン(90点以上)
   static constexpr double kMentalDamageCoefficient = 0.1;  // 精神力減少係数(10 - score/10)
   static constexpr StringView kServerLoadingMessage = U"国民統合情報サーバーと通信中...\n基本情報・職歴情報・資格情報を取得中..."; // サーバー通信中メッセージ
+  static constexpr StringView kLlmReplayChannel = U"job_search";  // LlamaReplayで評価結果を記録・再生するときのチャンネル名
+
+  // 評価用LLMのコンテキスト設定（最速化）
+  // コンテキストプールのキーにもなるため、事前確保と生成で同じ設定を使う
+  static llama_cpp::ContextConfig CreateLlmContextConfig() {
+    llama_cpp::ContextConfig context_config;
+    context_config.context_size = 256;
+    context_config.batch_size = 256;
+    context_config.threads = 8;
+    context_config.threads_batch = 8;
+    return context_config;
+  }
+
+  // 評価用LLMのコンテキストを事前に確保しておく
+  // フェーズ開始時（毎日）にコンテキストの確保が走らないよう、起動時に一度呼ぶ
+  // LLMの応答を再生している場合はモデルを使わないため何もしない
+  static void PrewarmLlmContext() {
+    if (llama_cpp::LlamaReplay::IsReplaying()) {
+      return;
+    }
+
+    auto model = llama_cpp::LlamaModelManager::GetInstance().GetModel(String(GameConst::kLlmModelId));
+    if (!model) {
+      DebugUtil::Console << U"PrewarmLlmContext: LLMモデルの取得に失敗しました";
+      return;
+    }
+
+    if (!llama_cpp::LlamaContextPool::GetInstance().Prewarm(model, CreateLlmContextConfig())) {
+      DebugUtil::Console << U"PrewarmLlmContext: コンテキストの事前確保に失敗しました";
+    }
+  }
 
   // LLMテキストジェネレーターを作成するstaticメソッド
-  static std::unique_ptr<llama_cpp::LlamaTextGenerator> CreateLlamaTextGenerator() {
+  // コンテキストはLlamaContextPoolから取得され、フェーズ終了時にプールへ返却される
+  static std::shared_ptr<llama_cpp::LlamaTextGenerator> CreateLlamaTextGenerator() {
     // LLMモデルマネージャーから共有モデルを取得
     auto& modelManager = llama_cpp::LlamaModelManager::GetInstance();
     auto model = modelManager.GetModel(String(GameConst::kLlmModelId));
@@ -52,20 +87,15 @@ class JobSearchPhase : public iPhase {
     }
 
     // LlamaTextGeneratorを作成
-    auto generator = std::make_unique<llama_cpp::LlamaTextGenerator>();
+    auto generator = std::make_shared<llama_cpp::LlamaTextGenerator>();
 
     // コンテキスト設定（最速化）
-    llama_cpp::ContextConfig context_config;
-    context_config.context_size = 256;
-    context_config.batch_size = 256;
-    context_config.threads = 8;
-    context_config.threads_batch = 8;
+    const llama_cpp::ContextConfig context_config = CreateLlmContextConfig();
 
     // サンプリング設定（最速化）
+    // スコアは数字のみなのでgreedyで確定的に選ぶ（ソート・softmaxを省略する高速パスが使われる）
     llama_cpp::SamplingConfig sampling_config;
-    sampling_config.temperature = 0.1f;
-    sampling_config.top_k = 5;
-    sampling_config.top_p = 0.5f;
+    sampling_config.chain = {llama_cpp::SamplerType::kGreedy};
 
     // システムプロンプト
     constexpr StringView system_prompt =
@@ -85,10 +115,46 @@ class JobSearchPhase : public iPhase {
     return generator;
   }
 
+  // 次のフェーズ開始前にLLMジェネレーターを用意しておく（LlmPrefetchPlannerから呼ばれる）
+  // 用意済みであればそれを返す。システムプロンプトのプリフィルは呼び出し側で行う
+  // LLMの応答を再生している場合はnullptrを返す
+  static std::shared_ptr<llama_cpp::LlamaTextGenerator> PrepareLlamaTextGenerator() {
+    if (llama_cpp::LlamaReplay::IsReplaying()) {
+      return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(preparedGeneratorMutex_);
+    if (!preparedGenerator_) {
+      preparedGenerator_ = CreateLlamaTextGenerator();
+    }
+    return preparedGenerator_;
+  }
+
+  // 先読みで用意したまま使われなかったLLMジェネレーターを破棄する
+  // 静的メンバーはMainより長く生きるため、終了時にモデルを解放する前に呼ぶこと
+  // （残しておくとコンテキストとモデルを保持したままになり、モデルが解放されない）
+  // 破棄（コンテキストの返却）はロックの外で行う
+  static void ReleasePreparedGenerator() {
+    std::shared_ptr<llama_cpp::LlamaTextGenerator> generator;
+    {
+      std::lock_guard<std::mutex> lock(preparedGeneratorMutex_);
+      generator = std::move(preparedGenerator_);
+    }
+  }
+
   // コンストラクタ
   JobSearchPhase() {
-    // LLMジェネレーターを初期化
-    llmGenerator_ = CreateLlamaTextGenerator();
+    // LLMジェネレーターを初期化（先読みで用意済みであればそれを引き継ぐ）
+    // LLMの応答を再生している場合は記録済みの評価結果を使うため作成しない
+    if (!llama_cpp::LlamaReplay::IsReplaying()) {
+      {
+        std::lock_guard<std::mutex> lock(preparedGeneratorMutex_);
+        llmGenerator_ = std::move(preparedGenerator_);
+      }
+      if (!llmGenerator_) {
+        llmGenerator_ = CreateLlamaTextGenerator();
+      }
+    }
 
     // パスワード入力演出を開始
     passwordInputUI_.Show();
@@ -236,6 +302,7 @@ class JobSearchPhase : public iPhase {
     // LLMの生成が完了したか確認
     if (llmTextBuffer_.IsGenerationComplete()) {
       const String generated_text = llmTextBuffer_.GetText();
+      llama_cpp::LlamaReplay::Record(kLlmReplayChannel, selfPRText_, generated_text);
 
       // 生成されたテキストから数字のみを抽出
       String number_str;
@@ -283,7 +350,13 @@ class JobSearchPhase : public iPhase {
   }
 
   // LLMによる評価を開始する
+  // LLMの応答を再生している場合は記録済みの評価結果を即座に完了扱いにする
   void StartLLMEvaluation(const String& selfPR) {
+    if (llama_cpp::LlamaReplay::IsReplaying()) {
+      llmTextBuffer_.CompleteWith(llama_cpp::LlamaReplay::Find(kLlmReplayChannel, selfPR));
+      return;
+    }
+
     if (!llmGenerator_) {
       DebugUtil::Console << U"JobSearchPhase: LLMが初期化されていません";
       return;
@@ -355,10 +428,14 @@ class JobSearchPhase : public iPhase {
   ResumeUI resumeUI_;                                            // 履歴書UIのインスタンス
   LoadingUI loadingUI_;                                          // ローディングUIのインスタンス
   RejectionListUI rejectionListUI_;                              // 不採用リストUIのインスタンス
-  std::unique_ptr<llama_cpp::LlamaTextGenerator> llmGenerator_;  // LLMテキスト生成器
+  std::shared_ptr<llama_cpp::LlamaTextGenerator> llmGenerator_;  // LLMテキスト生成器
   llama_cpp::LlamaTextBuffer llmTextBuffer_;                     // LLMテキストバッファ
   String selfPRText_;                                            // プレイヤーが入力した自己PR/志望動機のテキスト
   int32 evaluationScore_ = 0;                                    // LLMによる評価スコア(0-100)
   State currentState_ = State::PasswordInput;                    // 現在のフェーズ内の状態
   ServerLoadingUI serverLoadingUI_;                              // サーバーローディングUI
+
+  // 先読みで用意されたLLMジェネレーター（次のJobSearchPhaseが引き継ぐ）
+  static inline std::mutex preparedGeneratorMutex_;
+  static inline std::shared_ptr<llama_cpp::LlamaTextGenerator> preparedGenerator_;
 };
@@ -1,6 +1,7 @@
 ﻿// LoadingUI.h
 #pragma once
 #include <Siv3D.hpp>
+#include "Game/utility/GameClock.h"
 #include "ServerLoadingUI.h"
 #include "Game/utility/FontManager.h"
 #include "Game/utility/UiConst.h"
@@ -50,7 +51,7 @@ class LoadingUI {
     isVisible_ = true;
     // 広告の初期インデックスは表示時にランダムで決定する
     currentAdIndex_ = Random(0, static_cast<int32>(kAdvertisements.size()) - 1);
-    adChangeTimer_ = Timer{SecondsF{kAdChangeInterval}, StartImmediately::Yes };
+    adChangeTimer_ = Timer{SecondsF{kAdChangeInterval}, StartImmediately::Yes, GameClock::GetSteadyClock()};
 
     // 回転アイコンを初期化して表示（ロゴは LoadingUI が保持して描画する）
     rotatingIcon_.Initialize( kIconSize, kIconPos);
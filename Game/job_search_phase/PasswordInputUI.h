@@ -3,6 +3,7 @@
 #include <Siv3D.hpp>
 
 #include "Game/utility/FontManager.h"
+#include "Game/utility/GameClock.h"
 #include "Game/utility/UiConst.h"
 
 // 求職活動フェーズの冒頭で表示される、モノアイサーバーへのパスワード入力演出を行うUIクラス
@@ -57,8 +58,8 @@ class PasswordInputUI {
     displayPassword_.clear();
     currentCharIndex_ = 0;
     currentState_ = State::Display;
-    stateTimer_ = Timer{SecondsF(kDisplayDuration), StartImmediately::Yes};
-    inputTimer_ = Timer{SecondsF(kCharInputInterval)};
+    stateTimer_ = Timer{SecondsF(kDisplayDuration), StartImmediately::Yes, GameClock::GetSteadyClock()};
+    inputTimer_ = Timer{SecondsF(kCharInputInterval), StartImmediately::No, GameClock::GetSteadyClock()};
     // waitTimer_はInputWaitに遷移したタイミングで開始するためここではリセットしておく
     waitTimer_ = Timer{};
   }
@@ -130,7 +131,7 @@ class PasswordInputUI {
     if (stateTimer_.reachedZero()) {
       // 表示フェーズ終了、パスワード入力演出フェーズへ遷移
       currentState_ = State::PasswordInput;
-      inputTimer_ = Timer{SecondsF(kCharInputInterval), StartImmediately::Yes};
+      inputTimer_ = Timer{SecondsF(kCharInputInterval), StartImmediately::Yes, GameClock::GetSteadyClock()};
     }
   }
 
@@ -144,7 +145,7 @@ class PasswordInputUI {
       if (currentCharIndex_ >= kPasswordText.size()) {
         // 入力演出終了、InputWaitフェーズへ遷移して少し待ってからCompletedへ移行する
         currentState_ = State::InputWait;
-        waitTimer_ = Timer{SecondsF(kInputWaitDuration), StartImmediately::Yes};
+        waitTimer_ = Timer{SecondsF(kInputWaitDuration), StartImmediately::Yes, GameClock::GetSteadyClock()};
       } else {
         // 次の文字入力のためにタイマーをリセット
         inputTimer_.restart();
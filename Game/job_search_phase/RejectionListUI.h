@@ -5,6 +5,7 @@
 #include "Game/job_search_phase/RejectionInfo.h"
 #include "Game/utility/ConfirmDialog.h"
 #include "Game/utility/FontManager.h"
+#include "Game/utility/GameClock.h"
 #include "Game/utility/SoundManager.h"
 #include "Game/utility/UiConst.h"
 
@@ -231,5 +232,5 @@ class RejectionListUI {
   // 確認ダイアログ
   ConfirmDialog confirmDialog_;
   // 演出用タイマー
-  Stopwatch stopwatch_;
+  Stopwatch stopwatch_{StartImmediately::No, GameClock::GetSteadyClock()};
 };
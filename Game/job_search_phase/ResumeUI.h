@@ -4,7 +4,9 @@
 
 #include "Game/utility/ConfirmDialog.h"
 #include "Game/utility/FontManager.h"
+#include "Game/utility/GameClock.h"
 #include "Game/utility/GameConst.h"
+#include "Game/utility/GameInput.h"
 #include "Game/utility/SoundManager.h"
 #include "Game/utility/UiConst.h"
 
@@ -121,6 +123,7 @@ class ResumeUI {
         break;
 
       case State::WaitInput:
+        UpdateScriptedInput();
         break;
 
       default:
@@ -279,11 +282,28 @@ class ResumeUI {
 
       // 決定ボタンのクリック判定と処理
       if (buttonRect.leftClicked()) {
-        confirmDialog_.Show(U"この内容で提出しますか？", kResumeCenterPos);
+        ShowSubmitDialog();
       }
     }
   }
 
+  // 提出確認ダイアログを表示する
+  void ShowSubmitDialog() const {
+    confirmDialog_.Show(U"この内容で提出しますか？", kResumeCenterPos);
+  }
+
+  // スクリプト入力（ヘッドレス実行）のテキストを自己PRとして入力し、送信ボタンを押したものとして扱う
+  // 入力欄と送信ボタンはDraw()で処理されるため、Drawが呼ばれない場合はここで受け付ける
+  void UpdateScriptedInput() {
+    if (!ControlsEnabled() || isConfirmed_) {
+      return;
+    }
+    if (const auto text = GameInput::TakeSubmittedText()) {
+      selfPREditState_.text = text->substr(0, kMaxSelfPRLength);
+      ShowSubmitDialog();
+    }
+  }
+
   // キーボード打鍵音をランダムに再生する
   void PlayTypingSound() {
     const Array<String> typingSounds = {
@@ -399,7 +419,7 @@ class ResumeUI {
   mutable bool grayout_ = true;
 
   State state_ = State::WaitLogIn;
-  Stopwatch stopwatch_;
+  Stopwatch stopwatch_{StartImmediately::No, GameClock::GetSteadyClock()};
   int autoCompleteIndex_ = 0;  // 自動入力中の項目インデックス
 
   // enabled_ と確認ダイアログの表示状態を組み合わせて実際に操作可能かを返す
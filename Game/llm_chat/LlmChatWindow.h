@@ -2,6 +2,7 @@
 #include <Siv3D.hpp>
 
 #include "FrameWork/LlamaCpp/LlamaModel.h"
+#include "FrameWork/LlamaCpp/LlamaReplay.h"
 #include "FrameWork/LlamaCpp/LlamaTextBuffer.h"
 #include "FrameWork/LlamaCpp/LlamaTextGenerator.h"
 #include "FrameWork/UI/ChatMessageWindow.h"
@@ -10,10 +11,12 @@
 // チャットウィンドウ用の設定（UI 関連／LLM の初期プロンプトなど）
 // - input_area_height: 入力エリアの高さ（ピクセル）
 // - system_prompt: LLM に渡すシステムプロンプト（省略可）
+// - replay_channel: LlamaReplay で応答を記録・再生するときのチャンネル名（空なら記録・再生しない）
 struct LlmChatWindowSetting {
   double input_area_height = 30.0;
   s3d::StringView system_prompt;
   int max_input_char = 100;  // 最大入力文字数
+  s3d::StringView replay_channel;
 };
 
 // LlmChatWindow の構築に必要なパラメータをまとめた構造体
@@ -50,12 +53,7 @@ class LlmChatWindow {
     // チャット履歴の描画
     m_chat_window.Draw();
 
-    // 生成完了の監視（非同期生成が完了したらコールバック処理）
-    if (m_is_waiting_response && m_chat_message_buffer.IsGenerationComplete()) {
-      const auto generated_text = m_chat_message_buffer.GetText();
-      onResponseComplete(generated_text);
-      m_is_waiting_response = false;
-    }
+    UpdateResponse();
 
     // 入力エリアの配置計算
     auto chat_window_rect = m_chat_window.GetRect();
@@ -84,6 +82,43 @@ class LlmChatWindow {
     }
   }
 
+  // LLM 応答の監視だけを行う（描画や入力を伴わない更新。Update() からも呼ばれる）
+  // - 生成中テキストの逐次反映
+  // - 生成完了時のコールバック処理
+  void UpdateResponse() {
+    if (!m_is_waiting_response) {
+      return;
+    }
+
+    // 生成中のテキストを逐次表示（更新があったフレームのみ再レイアウト）
+    const size_t version = m_chat_message_buffer.GetVersion();
+    if (version != m_streaming_version) {
+      m_streaming_version = version;
+      m_chat_window.UpdateStreamingMessage(m_chat_message_buffer.GetText());
+    }
+
+    // 生成完了の監視（非同期生成が完了したらコールバック処理）
+    if (m_chat_message_buffer.IsGenerationComplete()) {
+      const auto generated_text = m_chat_message_buffer.GetText();
+      if (!m_setting.replay_channel.isEmpty()) {
+        llama_cpp::LlamaReplay::Record(m_setting.replay_channel, m_last_prompt, generated_text);
+      }
+      onResponseComplete(generated_text);
+      m_is_waiting_response = false;
+    }
+  }
+
+  // 送信ボタンを押したときと同じようにメッセージを送信する（スクリプト入力用）
+  // 入力エリアが無効のとき、または応答待ちのときは何もしない
+  void Submit(const s3d::String& text) {
+    if (m_input_area_disabled || m_is_waiting_response) {
+      return;
+    }
+    llama_cpp::LlmRequest request;
+    request.prompt = text;
+    startResponse(request);
+  }
+
   // 外部からメッセージ送信完了時のコールバックを登録できる
   void SetOnMessageReceived(std::function<void(s3d::StringView)> on_message_receive) {
     m_on_message_receive = on_message_receive;
@@ -121,6 +156,16 @@ class LlmChatWindow {
     m_input_area_disabled = disabled;
   }
 
+  // 入力エリアが無効化されているかどうかを取得する
+  [[nodiscard]] bool IsInputAreaDisabled() const noexcept {
+    return m_input_area_disabled;
+  }
+
+  // テキスト生成器を取得する（プリフィルなどの先読みに使う。未初期化なら nullptr）
+  [[nodiscard]] std::shared_ptr<llama_cpp::LlamaTextGenerator> GetGenerator() const {
+    return m_chat_message_generator;
+  }
+
   private:
   // LlamaTextGenerator の初期化（静的ヘルパ）
   // - model: 既にロードされた LlamaModel
@@ -160,16 +205,35 @@ class LlmChatWindow {
   // - バッファをクリアし、ジェネレータに生成を要求する
   // - ユーザーの送信メッセージをチャットに追加し、入力をクリアする
   void startResponse(const llama_cpp::LlmRequest& request) {
+    m_last_prompt = request.prompt;
+    m_chat_message_buffer.ClearBuffer();
+
+    // 再生中は記録済みの応答を完了済みとして扱う（ジェネレータは不要）
+    if (!m_setting.replay_channel.isEmpty() && llama_cpp::LlamaReplay::IsReplaying()) {
+      m_chat_message_buffer.CompleteWith(
+        llama_cpp::LlamaReplay::Find(m_setting.replay_channel, request.prompt));
+      beginWaitingResponse(request);
+      return;
+    }
+
     if (!m_chat_message_generator) {
       DebugUtil::Console
         << U"LlamaTextGenerator is not initialized. Call Initialize() first.";
       return;
     }
 
-    m_chat_message_buffer.ClearBuffer();
     m_chat_message_buffer.StartGeneration(*m_chat_message_generator, request);
+    beginWaitingResponse(request);
+  }
+
+  // 送信メッセージを履歴に追加し、応答待ちの状態にする
+  void beginWaitingResponse(const llama_cpp::LlmRequest& request) {
     m_chat_window.AddMessage(request.prompt, Sender::Self);
 
+    // 応答は最初のトークンが届いた時点から逐次表示する
+    m_chat_window.BeginStreamingMessage(Sender::Partner);
+    m_streaming_version = m_chat_message_buffer.GetVersion();
+
     // 送信時コールバックを実行（登録されていれば）
     if (m_on_message_sent) {
       m_on_message_sent(request.prompt);
@@ -179,12 +243,12 @@ class LlmChatWindow {
     m_is_waiting_response = true;
   }
 
-  // 生成完了時の共通処理（コールバック通知とチャットへの追加）
+  // 生成完了時の共通処理（コールバック通知とストリーミング表示の確定）
   void onResponseComplete(const s3d::String& text) {
     if (m_on_message_receive) {
       m_on_message_receive(text);
     }
-    m_chat_window.AddMessage(text, Sender::Partner);
+    m_chat_window.EndStreamingMessage(text);
   }
 
   // メンバ変数群
@@ -199,4 +263,6 @@ class LlmChatWindow {
   std::function<void(s3d::StringView)> m_on_message_receive;  // 生成完了時の外部通知コールバック
   std::function<void(s3d::StringView)> m_on_message_sent;     // メッセージ送信時の外部通知コールバック
   bool m_is_waiting_response = false;                         // LLM 応答を待っているかのフラグ
+  size_t m_streaming_version = 0;                             // 最後に表示へ反映したバッファの更新回数
+  s3d::String m_last_prompt;                                  // 最後に送信したプロンプト（応答の記録用）
 };
@@ -6,6 +6,7 @@
 #include "Game/base_system/BlackOutUI.h"
 #include "Game/base_system/MessageWindowUI.h"
 #include "Game/base_system/PhaseManager.h"
+#include "Game/utility/GameClock.h"
 #include "Game/utility/MouseEffectManager.h"
 #include "Game/utility/SoundManager.h"
 #include "Game/utility/iPhase.h"
@@ -142,5 +143,5 @@ class NightDreamPhase : public iPhase {
 
   // データメンバ
   State currentState_ = State::FadeInWait;  // 現在の状態
-  Stopwatch intervalTimer_;                 // インターバル計測用タイマー(複数の状態で使い回し)
+  Stopwatch intervalTimer_{StartImmediately::No, GameClock::GetSteadyClock()};  // インターバル計測用タイマー(複数の状態で使い回し)
 };
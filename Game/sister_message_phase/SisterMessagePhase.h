@@ -10,6 +10,7 @@
 #include "Game/base_system/SisterMessageUI.h"
 #include "Game/base_system/SisterMessageUIManager.h"
 #include "Game/utility/DebugUtil.h"
+#include "Game/utility/GameClock.h"
 #include "Game/utility/GameConst.h"
 #include "Game/utility/SoundManager.h"
 #include "Game/utility/iPhase.h"
@@ -194,5 +195,5 @@ class SisterMessagePhase : public iPhase {
   State currentState_ = State::Chatting;  // フェーズの現在の状態
   bool transitionStarted_ = false;        // フェード遷移が開始済みかどうか（Work移行の二重呼び出し防止）
 
-  Stopwatch waitTimer_;  // ウィンドウ表示待機に使うタイマー
+  Stopwatch waitTimer_{StartImmediately::No, GameClock::GetSteadyClock()};  // ウィンドウ表示待機に使うタイマー
 };
@@ -6,6 +6,7 @@
 #include "Game/base_system/GameCommonData.h"
 #include "Game/base_system/MessageWindowUI.h"
 #include "Game/base_system/PhaseManager.h"
+#include "Game/utility/GameClock.h"
 #include "Game/utility/iPhase.h"
 
 // 一日の終わりフェーズを管理するクラス
@@ -113,5 +114,5 @@ class SunsetPhase : public iPhase {
 
   // データメンバ
   State currentState_ = State::FadeInWait;  // 現在の状態
-  Stopwatch phaseChangeTimer_;               // フェーズ遷移待機用タイマー
+  Stopwatch phaseChangeTimer_{StartImmediately::No, GameClock::GetSteadyClock()};  // フェーズ遷移待機用タイマー
 };
@@ -3,6 +3,7 @@
 #include <Siv3D.hpp>
 
 #include "Game/utility/FontManager.h"
+#include "Game/utility/GameInput.h"
 #include "Game/utility/UiConst.h"
 
 // はい/いいえの確認ダイアログを表示するクラス
@@ -66,6 +67,14 @@ class ConfirmDialog {
   // 「いいえ」ボタンが押されたかどうかを返す
   [[nodiscard]] bool IsCancelled() const noexcept { return isCancelled_; }
 
+  // 「はい」ボタンの矩形を計算する（showOnlyYes の場合はボタンを中央に寄せる）
+  // スクリプト入力でボタンを押す位置を求めるときにも使う
+  [[nodiscard]] static RectF GetYesButtonRect(const Vec2& dialogPos, bool showOnlyYes) {
+    return showOnlyYes
+             ? RectF{dialogPos - Vec2{kDefaultButtonSize.x / 2, -20}, kDefaultButtonSize}
+             : RectF{dialogPos - Vec2{kDefaultButtonSize.x + kButtonSpacing / 2, -20}, kDefaultButtonSize};
+  }
+
   // 更新処理（毎フレーム呼ぶ）
   void Update() {
     if (!isVisible_) {
@@ -74,18 +83,15 @@ class ConfirmDialog {
 
     // ボタンの位置を計算
     const RectF dialogRect{dialogPos_ - kDefaultDialogSize / 2, kDefaultDialogSize};
-    // showOnlyYes_ の場合はボタンを中央に寄せる
-    const RectF yesButton = showOnlyYes_
-                                ? RectF{dialogRect.center() - Vec2{kDefaultButtonSize.x / 2, -20}, kDefaultButtonSize}
-                                : RectF{dialogRect.center() - Vec2{kDefaultButtonSize.x + kButtonSpacing / 2, -20}, kDefaultButtonSize};
+    const RectF yesButton = GetYesButtonRect(dialogRect.center(), showOnlyYes_);
     const RectF noButton = RectF{dialogRect.center() - Vec2{-kButtonSpacing / 2, -20}, kDefaultButtonSize};
 
     // ボタンのクリック判定
-    if (yesButton.leftClicked()) {
+    if (GameInput::LeftClicked(yesButton)) {
       isConfirmed_ = true;
       isVisible_ = false;
     }
-    if (!showOnlyYes_ && noButton.leftClicked()) {
+    if (!showOnlyYes_ && GameInput::LeftClicked(noButton)) {
       isCancelled_ = true;
       isVisible_ = false;
     }
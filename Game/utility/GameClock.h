@@ -0,0 +1,70 @@
+﻿// GameClock.h
+#pragma once
+#include <Siv3D.hpp>
+
+// ゲームロジックが参照する時計を一元管理するクラス
+// 通常はSiv3Dの実時間をそのまま返し、ヘッドレス実行では仮想時間に切り替えてAdvance()でだけ進める
+// モノステートパターンで実装され、どこからでもアクセス可能
+// - 経過時間は Scene::DeltaTime() / Scene::Time() の代わりに DeltaTime() / Time() を使う
+// - Stopwatch / Timer は GetSteadyClock() を渡して作る
+//     Stopwatch timer_{StartImmediately::No, GameClock::GetSteadyClock()};
+// 描画だけに使う演出（マーカーの揺れなど）は実時間のままでよい
+class GameClock {
+  public:
+  GameClock() = delete;
+  ~GameClock() = delete;
+
+  // Stopwatch / Timer に渡す時計（仮想時間中は Advance() でだけ進む）
+  [[nodiscard]] static ISteadyClock* GetSteadyClock() noexcept {
+    static SteadyClock clock;
+    return &clock;
+  }
+
+  // 前フレームからの経過時間（秒）
+  [[nodiscard]] static double DeltaTime() noexcept {
+    return isVirtual_ ? virtualDeltaTime_ : Scene::DeltaTime();
+  }
+
+  // アプリケーション開始からの経過時間（秒）
+  [[nodiscard]] static double Time() noexcept {
+    return isVirtual_ ? virtualTime_ : Scene::Time();
+  }
+
+  // 仮想時間に切り替える（現在の実時間から続けて進める）
+  // 開始済みのStopwatchが巻き戻らないよう、Stopwatchを使い始める前に呼ぶ
+  static void EnableVirtualTime() {
+    virtualTime_ = Scene::Time();
+    virtualMicrosecOrigin_ = s3d::Time::GetMicrosec() - static_cast<uint64>(virtualTime_ * 1e6);
+    virtualDeltaTime_ = 0.0;
+    isVirtual_ = true;
+  }
+
+  // 仮想時間を進める（次のフレームの DeltaTime() は deltaTime になる）
+  static void Advance(double deltaTime) noexcept {
+    virtualDeltaTime_ = deltaTime;
+    virtualTime_ += deltaTime;
+  }
+
+  // 仮想時間で動作しているかどうか
+  [[nodiscard]] static bool IsVirtual() noexcept {
+    return isVirtual_;
+  }
+
+  private:
+  // 仮想時間中は virtualTime_ を返す ISteadyClock
+  class SteadyClock : public ISteadyClock {
+    public:
+    uint64 getMicrosec() override {
+      if (!isVirtual_) {
+        return s3d::Time::GetMicrosec();
+      }
+      return virtualMicrosecOrigin_ + static_cast<uint64>(virtualTime_ * 1e6);
+    }
+  };
+
+  // データメンバ（モノステートパターンのため静的）
+  static inline bool isVirtual_ = false;              // 仮想時間で動作しているかどうか
+  static inline double virtualTime_ = 0.0;            // 仮想時間の現在時刻（秒）
+  static inline double virtualDeltaTime_ = 0.0;       // 仮想時間の直前の進み幅（秒）
+  static inline uint64 virtualMicrosecOrigin_ = 0;    // 仮想時間0秒に対応するマイクロ秒
+};
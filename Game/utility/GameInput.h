@@ -0,0 +1,80 @@
+﻿// GameInput.h
+#pragma once
+#include <Siv3D.hpp>
+
+// ゲームロジックが参照するマウス入力とテキスト入力を一元管理するクラス
+// 通常はSiv3Dの入力をそのまま返し、ヘッドレス実行ではスクリプトが毎フレーム入力を差し替える
+// モノステートパターンで実装され、どこからでもアクセス可能
+// - MouseL.down() / Cursor::Pos() の代わりに LeftDown() / CursorPos() を使う
+// - 図形のクリック判定は shape.leftClicked() の代わりに LeftClicked(shape) を使う
+class GameInput {
+  public:
+  GameInput() = delete;
+  ~GameInput() = delete;
+
+  // スクリプトが与える1フレーム分の入力
+  struct Frame {
+    bool left_down = false;  // 左クリックされたか
+    Point cursor_pos{0, 0};  // カーソル位置
+  };
+
+  // 左ボタンがこのフレームに押されたかどうか
+  [[nodiscard]] static bool LeftDown() {
+    return isScripted_ ? frame_.left_down : MouseL.down();
+  }
+
+  // カーソル位置
+  [[nodiscard]] static Point CursorPos() {
+    return isScripted_ ? frame_.cursor_pos : Cursor::Pos();
+  }
+
+  // カーソルが図形の上にあるかどうか
+  template <class Shape>
+  [[nodiscard]] static bool MouseOver(const Shape& shape) {
+    return isScripted_ ? shape.intersects(frame_.cursor_pos) : shape.mouseOver();
+  }
+
+  // 図形がこのフレームにクリックされたかどうか
+  template <class Shape>
+  [[nodiscard]] static bool LeftClicked(const Shape& shape) {
+    return isScripted_ ? (frame_.left_down && shape.intersects(frame_.cursor_pos)) : shape.leftClicked();
+  }
+
+  // スクリプトが入力欄へ送ったテキストを1つ取り出す（通常の実行では常にnone）
+  // テキストを受け付けられる状態のUIだけが呼び、取り出したテキストは確定入力として扱う
+  [[nodiscard]] static Optional<String> TakeSubmittedText() {
+    if (!isScripted_ || submittedTexts_.isEmpty()) {
+      return none;
+    }
+    String text = submittedTexts_.front();
+    submittedTexts_.pop_front();
+    return text;
+  }
+
+  // スクリプト入力に切り替える
+  static void SetScripted(bool scripted) {
+    isScripted_ = scripted;
+    frame_ = Frame{};
+    submittedTexts_.clear();
+  }
+
+  [[nodiscard]] static bool IsScripted() noexcept {
+    return isScripted_;
+  }
+
+  // このフレームの入力を設定する（スクリプト入力時のみ有効）
+  static void SetFrame(const Frame& frame) noexcept {
+    frame_ = frame;
+  }
+
+  // 入力欄へ送るテキストを積む（先に積んだものから取り出される）
+  static void SetSubmittedTexts(const Array<String>& texts) {
+    submittedTexts_ = texts;
+  }
+
+  private:
+  // データメンバ（モノステートパターンのため静的）
+  static inline bool isScripted_ = false;         // スクリプト入力かどうか
+  static inline Frame frame_;                     // このフレームのスクリプト入力
+  static inline Array<String> submittedTexts_;    // 未消費のテキスト入力
+};
@@ -4,6 +4,8 @@
 #pragma once
 #include <Siv3D.hpp>
 
+#include "GameClock.h"
+#include "GameInput.h"
 #include "SoundManager.h"
 #include "TweenUtil.h"
 
@@ -26,7 +28,7 @@ class MouseEffectManager {
   }
 
   // 毎フレーム呼び出し、アクティブなエフェクトを更新する
-  // MouseL.down()を使用してクリック判定を行い、クリック時にエフェクトを追加してSEを再生する
+  // GameInput::LeftDown()を使用してクリック判定を行い、クリック時にエフェクトを追加してSEを再生する
   // 持続時間を超えたエフェクトも削除
   static void Update() {
     if (!isInitialized_) {
@@ -34,8 +36,8 @@ class MouseEffectManager {
     }
 
     // マウス左クリック判定
-    if (MouseL.down()) {
-      AddEffect(Cursor::Pos());
+    if (GameInput::LeftDown()) {
+      AddEffect(GameInput::CursorPos());
       PlayClickSound();
     }
 
@@ -81,7 +83,7 @@ class MouseEffectManager {
   // 内部構造体: 個別のクリックエフェクト
   struct ClickEffect {
     Vec2 position;     // クリック位置の座標
-    Stopwatch timer;   // エフェクト開始からの経過時間を計測
+    Stopwatch timer{StartImmediately::No, GameClock::GetSteadyClock()};  // エフェクト開始からの経過時間を計測
     double duration;   // エフェクトの持続時間（秒）
     ColorF color;      // エフェクトの色
     double maxRadius;  // 輪の最大半径（ピクセル）
@@ -45,5 +45,20 @@ namespace phase_type_util {
     [[nodiscard]] inline String ToString(PhaseType p) {
         return String(ToStringView(p));
     }
+
+    // 通常のゲーム進行で次に来る可能性が最も高いフェーズ
+    // LLMの先読みなど投機的な準備に使う（分岐先はゲームを継続する側を優先する）
+    [[nodiscard]] inline PhaseType GetLikelyNextPhase(PhaseType p) noexcept {
+        switch (p) {
+        case PhaseType::Introduction:  return PhaseType::Sunrise;
+        case PhaseType::Sunrise:       return PhaseType::JobSearch;
+        case PhaseType::JobSearch:     return PhaseType::SisterMessage;
+        case PhaseType::SisterMessage: return PhaseType::Work;
+        case PhaseType::Work:          return PhaseType::Sunset;
+        case PhaseType::Sunset:        return PhaseType::NightDream;
+        case PhaseType::NightDream:    return PhaseType::Sunrise;
+        default:                       return PhaseType::Introduction;
+        }
+    }
 } // namespace phase_type_util
 
@@ -2,6 +2,7 @@
 #pragma once
 #include <Siv3D.hpp>
 
+#include "Game/utility/GameClock.h"
 #include "Game/utility/UiConst.h"
 
 // 回転するローディングアイコンを担当するヘッダオンリーのユーティリティクラス
@@ -39,14 +40,14 @@ class RotatingIcon {
 
   [[nodiscard]] bool IsVisible() const noexcept { return isVisible_; }
 
-  // 毎フレームの更新（呼び出し側でScene::DeltaTime()が進む）
+  // 毎フレームの更新（呼び出し側でGameClock::DeltaTime()が進む）
   void Update() {
     if (!isVisible_) return;
 
-    elapsedTime_ += Scene::DeltaTime();
+    elapsedTime_ += GameClock::DeltaTime();
     const double phase = (Math::TwoPi * elapsedTime_) / rotationModulationPeriod_;
     const double modulation = 1.0 + rotationModulationAmplitude_ * Math::Sin(phase);
-    rotationAngle_ += rotationSpeed_ * modulation * Scene::DeltaTime();
+    rotationAngle_ += rotationSpeed_ * modulation * GameClock::DeltaTime();
     if (rotationAngle_ >= 360.0) {
       rotationAngle_ = std::fmod(rotationAngle_, 360.0);
     }
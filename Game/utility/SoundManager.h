@@ -5,6 +5,7 @@
 #include <Siv3D.hpp>
 
 #include "Game/utility/DebugUtil.h"
+#include "Util/FrameProfiler.h"
 
 // ゲーム内で使用するBGMとSE(効果音)を一元管理するユーティリティクラス
 // モノステートパターンで実装され、どこからでもアクセス可能
@@ -28,6 +29,7 @@ class SoundManager {
       return;
     }
 
+    const FrameProfiler::Scope scope{"SoundManager::Update"};
     UpdateCrossFade(deltaTime);
   }
 
@@ -0,0 +1,33 @@
+﻿// ConveyorCD.h
+// ECS版ベルトコンベア（ConveyorWorld）で使うコンポーネント
+
+#pragma once
+#include <Siv3D.hpp>
+#include <array>
+
+#include "FrameWork/flecs/flecs.h"
+
+// ベルトに流れる部品
+// ボルトのエンティティは部品ごとに最大数だけ子として作っておき、プールから取り出すたびに使う数だけ有効にする
+struct ConveyorPartCD {
+  static constexpr int32 kMaxBoltCount = 4;
+
+  int32 bolt_count = 0;
+  std::array<flecs::entity, kMaxBoltCount> bolts;
+};
+
+// 部品に付いた六角ボルト（位置は親の部品からの相対位置LocalTransformCDで持つ）
+struct ConveyorBoltCD {
+  bool is_tightened = false;
+  bool is_animating = false;
+  double animation_elapsed = 0.0;  // 締めるアニメーションの経過時間（秒）
+};
+
+// コンベア全体の状態
+// conveyor_despawn_sysがベルトの端を越えた部品をfinishedに積み、ConveyorWorldがプールへ戻す
+struct ConveyorSingletonCD {
+  double speed = 0.0;      // ベルトの速度（ワールド単位/秒）
+  double despawn_x = 0.0;  // 部品の左端がこのX座標を越えたら回収する
+
+  Array<flecs::entity> finished;
+};
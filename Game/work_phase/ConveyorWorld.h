@@ -0,0 +1,325 @@
+﻿// ConveyorWorld.h
+// ECS版ベルトコンベア（部品とボルトをflecsのエンティティとして扱う）
+
+#pragma once
+#include <Siv3D.hpp>
+
+#include "ConveyorCD.h"
+#include "FrameWork/CD/ColorCD.h"
+#include "FrameWork/CD/LocalTransformCD.h"
+#include "FrameWork/CD/MeshCD.h"
+#include "FrameWork/CD/PickableCD.h"
+#include "FrameWork/CD/PositionCD.h"
+#include "FrameWork/CD/RotationCD.h"
+#include "FrameWork/CD/SelectingTagCD.h"
+#include "FrameWork/CD/TextureCD.h"
+#include "FrameWork/SingletonCD/PickingSingletonCD.h"
+#include "FrameWork/SingletonCD/SelectionSingletonCD.h"
+#include "FrameWork/System/InstancedRenderingSystem.h"
+#include "FrameWork/System/PickingSystem.h"
+#include "FrameWork/System/TransformSystem.h"
+#include "FrameWork/Util/AssetCache.h"
+#include "FrameWork/Util/EcsThreadUtil.h"
+#include "Game/utility/GameInput.h"
+#include "Game/utility/SoundManager.h"
+#include "Game/utility/TweenUtil.h"
+#include "HexBolt.h"
+#include "MachineParts.h"
+#include "FrameWork/flecs/flecs.h"
+
+// 多数の部品を同時に流すためのECS版コンベア
+// MachineParts/HexBoltと同じ見た目と操作を、次の仕組みで部品数に比例しないコストで行う
+//   生成と破棄 : 部品とボルトはプレハブから作り、ベルトを抜けたらdisableしてプールへ戻す
+//   移動       : conveyor_move_sysが部品だけを動かし、ボルトはTransformSystemが親に追従させる
+//   クリック   : PickingSystemが1フレームに1本のレイでボルト（PickableCD）のBVHを引き、
+//                選ばれたボルト（SelectingTagCD）をconveyor_bolt_select_sysが締め始める
+//   描画       : InstancedRenderingSystemが部品本体とボルトをそれぞれ1回のインスタンス描画で描く
+// 更新（update）と描画（draw）を分けて呼べるよう、worldのパイプラインは分けて実行する
+// worldは作業フェーズをまたいで使い回し、日が変わったらReset()で全ての部品をプールへ戻す
+class ConveyorWorld {
+  public:
+  static_assert(ConveyorPartCD::kMaxBoltCount == MachineParts::kMaxBoltCount);
+
+  ConveyorWorld() {
+    // multi_threaded()のシステム（conveyor_move_sys）をワーカースレッドで分割実行する（パイプライン実行前に設定）
+    EcsThreadUtil::EnableMultiThreading(world_);
+    world_.add<ConveyorSingletonCD>();
+
+    partPrefab_ = world_.prefab("ConveyorPartPrefab");
+    partPrefab_.add<PositionCD>();
+    partPrefab_.add<RotationCD>();
+    partPrefab_.add<ConveyorPartCD>();
+    partPrefab_.set<MeshCD>(MeshCD{AssetCache::GetBoxMesh(MachineParts::kBodySize)});
+    partPrefab_.set<TextureCD>(
+      TextureCD{AssetCache::GetTexture(MachineParts::kMetalTexturePath)});
+
+    boltPrefab_ = world_.prefab("ConveyorBoltPrefab");
+    boltPrefab_.add<PositionCD>();
+    boltPrefab_.add<RotationCD>();
+    boltPrefab_.add<LocalTransformCD>();
+    boltPrefab_.add<ConveyorBoltCD>();
+    boltPrefab_.set<ColorCD>(ColorCD{HexBolt::kDefaultColor});
+    boltPrefab_.set<MeshCD>(MeshCD{HexBolt::GetBoltMesh()});
+
+    // ピッキング（PreUpdate）はゲームロジック（OnUpdate）より先に専用のパイプラインで実行する
+    PickingSystem::Register(world_);
+
+    RegisterSystems();
+
+    // 描画フェーズ（PreStore）のシステムだけを描画時に実行する
+    TransformSystem::Register(world_);
+    InstancedRenderingSystem::Register(world_);
+
+    pickingPipeline_ =
+      world_.pipeline().with(flecs::System).with(flecs::PreUpdate).build();
+    updatePipeline_ =
+      world_.pipeline().with(flecs::System).with(flecs::OnUpdate).build();
+    drawPipeline_ =
+      world_.pipeline().with(flecs::System).with(flecs::PreStore).build();
+  }
+
+  // 部品をボルトごとcount個まで先に作ってプールへ入れておく（遊んでいる間にエンティティを作らないため）
+  void Reserve(int32 count) {
+    while (activeCount_ + static_cast<int32>(freeParts_.size()) < count) {
+      PushToPool(CreatePart());
+    }
+  }
+
+  // ベルト上の部品を全てプールへ戻し、前の作業フェーズの状態を持ち越さないようにする
+  void Reset() {
+    Array<flecs::entity> activeParts;
+    world_.each([&](flecs::entity part, const ConveyorPartCD&) {
+      activeParts << part;
+    });
+    for (const flecs::entity part : activeParts) {
+      ReleasePart(part);
+    }
+    GetConveyor().finished.clear();
+    world_.get_ref<SelectionSingletonCD>()->Select(flecs::entity{});
+    world_.get_ref<PickingSingletonCD>()->input.reset();
+  }
+
+  // 部品をプールから取り出してstartPosに置く（ボルトの数と位置はMachinePartsと同じ規則で決める）
+  flecs::entity Spawn(const Vec3& startPos) {
+    flecs::entity part = AcquirePart();
+    part.set<PositionCD>(PositionCD{startPos});
+
+    ConveyorPartCD& partCD = part.get_mut<ConveyorPartCD>();
+    partCD.bolt_count =
+      Random(MachineParts::kMinBoltCount, MachineParts::kMaxBoltCount);
+
+    const Point randomArea{
+      static_cast<int32>(MachineParts::kBodySize.x - HexBolt::kBoltRadius * 2),
+      static_cast<int32>(MachineParts::kBodySize.z - HexBolt::kBoltRadius * 2)};
+    for (int32 i = 0; i < ConveyorPartCD::kMaxBoltCount; ++i) {
+      flecs::entity bolt = partCD.bolts[i];
+      if (i >= partCD.bolt_count) {
+        bolt.disable();
+        continue;
+      }
+      const Vec3 offset{
+        Random(-randomArea.x / 2, randomArea.x / 2),
+        MachineParts::kBodySize.y / 2 + HexBolt::kBoltHeight / 2,
+        Random(-randomArea.y / 2, randomArea.y / 2)};
+      bolt.enable();
+      bolt.set<LocalTransformCD>(LocalTransformCD{offset});
+      bolt.set<ConveyorBoltCD>(ConveyorBoltCD{});
+      bolt.set<PickableCD>(PickableCD{HexBolt::kClickRadius});
+      bolt.set<ColorCD>(ColorCD{HexBolt::kDefaultColor});
+      // 次の描画でTransformSystemが求めるまでの間もクリックできるようにしておく
+      bolt.set<PositionCD>(PositionCD{startPos + offset});
+      bolt.set<RotationCD>(RotationCD{});
+    }
+    return part;
+  }
+
+  // 部品を動かし、ボルトのクリックとアニメーションを処理する
+  // ベルトを抜けた部品はプールへ戻し、全てのボルトが締められていた数を返す
+  int32 Update(double deltaTime, const BasicCamera3D& camera, double speed,
+               double despawnX) {
+    ConveyorSingletonCD& conveyor = GetConveyor();
+    conveyor.speed = speed;
+    conveyor.despawn_x = despawnX;
+    conveyor.finished.clear();
+
+    // カーソルからのレイはこのフレームに1本だけ作り、PickingSystemに渡す
+    world_.get_ref<PickingSingletonCD>()->input = PickingSingletonCD::Input{
+      camera.screenToRay(GameInput::CursorPos()), GameInput::LeftDown()};
+
+    world_.run_pipeline(pickingPipeline_, static_cast<float>(deltaTime));
+    world_.run_pipeline(updatePipeline_, static_cast<float>(deltaTime));
+
+    int32 completed = 0;
+    for (const flecs::entity part : GetConveyor().finished) {
+      if (IsCompleted(part)) {
+        ++completed;
+      }
+      ReleasePart(part);
+    }
+    return completed;
+  }
+
+  // ボルトの姿勢を親に合わせてから、部品とボルトをインスタンス描画する
+  // カメラとライトは呼び出し側で設定しておく
+  void Draw() const {
+    world_.run_pipeline(drawPipeline_);
+  }
+
+  // ベルト上にある部品の数
+  [[nodiscard]] int32 GetActiveCount() const noexcept {
+    return activeCount_;
+  }
+
+  private:
+  void RegisterSystems() {
+    // 部品をベルトの速度で右へ動かす
+    // 部品ごとに独立したデータ変換なのでワーカースレッドで分割実行する
+    world_
+      .system<PositionCD, const ConveyorPartCD, const ConveyorSingletonCD>(
+        "conveyor_move_sys")
+      .term_at(2)
+      .src<ConveyorSingletonCD>()
+      .kind(flecs::OnUpdate)
+      .without(flecs::Prefab)
+      .multi_threaded()
+      .each([](flecs::iter& it, size_t, PositionCD& pos, const ConveyorPartCD&,
+               const ConveyorSingletonCD& conveyor) {
+        pos.pos.x += conveyor.speed * it.delta_time();
+      });
+
+    // ベルトの端を越えた部品を回収対象にする（finishedへ積むためメインスレッドで実行する）
+    world_
+      .system<const PositionCD, const ConveyorPartCD, ConveyorSingletonCD>(
+        "conveyor_despawn_sys")
+      .term_at(2)
+      .src<ConveyorSingletonCD>()
+      .kind(flecs::OnUpdate)
+      .without(flecs::Prefab)
+      .each([](flecs::iter& it, size_t i, const PositionCD& pos,
+               const ConveyorPartCD&, ConveyorSingletonCD& conveyor) {
+        if (pos.pos.x - MachineParts::kBodySize.x / 2 > conveyor.despawn_x) {
+          conveyor.finished.push_back(it.entity(i));
+        }
+      });
+
+    // PickingSystemがクリックで選んだボルトを締め始める
+    // 締め始めたボルトはPickableCDを外し、以降のピッキングの対象から外す
+    // 選択は1回のクリックで使い切る（プールへ戻したボルトに選択が残らないようにする）
+    world_
+      .system<ConveyorBoltCD, SelectionSingletonCD>("conveyor_bolt_select_sys")
+      .term_at(1)
+      .src<SelectionSingletonCD>()
+      .with<SelectingTagCD>()
+      .kind(flecs::OnUpdate)
+      .without(flecs::Prefab)
+      .each([](flecs::entity e, ConveyorBoltCD& bolt,
+               SelectionSingletonCD& selection) {
+        if (!bolt.is_tightened && !bolt.is_animating) {
+          bolt.is_animating = true;
+          bolt.animation_elapsed = 0.0;
+          e.remove<PickableCD>();
+          SoundManager::PlaySE(U"se_wrench");
+        }
+        selection.Select(flecs::entity{});
+      });
+
+    // 締めるアニメーション（HexBolt::Updateと同じ動き）
+    // 書き込んだテーブルはLocalTransformCDが変更扱いになり、TransformSystemが姿勢を求め直す
+    // アニメーション中のボルトがないテーブルはskip()し、変更扱いにしない
+    world_
+      .system<LocalTransformCD, ConveyorBoltCD, ColorCD>(
+        "conveyor_bolt_tighten_sys")
+      .kind(flecs::OnUpdate)
+      .without(flecs::Prefab)
+      .run([](flecs::iter& it) {
+        while (it.next()) {
+          auto local = it.field<LocalTransformCD>(0);
+          auto bolt = it.field<ConveyorBoltCD>(1);
+          auto color = it.field<ColorCD>(2);
+
+          bool is_any_animating = false;
+          for (auto i : it) {
+            if (!bolt[i].is_animating) {
+              continue;
+            }
+            is_any_animating = true;
+            bolt[i].animation_elapsed += it.delta_time();
+            const double progress = Min(
+              bolt[i].animation_elapsed / HexBolt::kAnimationDuration, 1.0);
+            const double eased = TweenUtil::EaseOutCubic(progress);
+            local[i].rot = Quaternion::RotateY(-eased * HexBolt::kTargetRotation);
+            if (progress >= 1.0) {
+              bolt[i].is_animating = false;
+              bolt[i].is_tightened = true;
+              color[i].c = ColorF{HexBolt::kTightenedColor};
+            }
+          }
+          if (!is_any_animating) {
+            it.skip();
+          }
+        }
+      });
+  }
+
+  // 空いている部品があれば再利用し、なければボルトごと新しく作る
+  flecs::entity AcquirePart() {
+    ++activeCount_;
+    if (!freeParts_.isEmpty()) {
+      flecs::entity part = freeParts_.back();
+      freeParts_.pop_back();
+      part.enable();
+      return part;
+    }
+    return CreatePart();
+  }
+
+  // 部品とボルトのエンティティをプレハブから作る
+  flecs::entity CreatePart() {
+    flecs::entity part = world_.entity().is_a(partPrefab_);
+    ConveyorPartCD partCD;
+    for (auto& bolt : partCD.bolts) {
+      bolt = world_.entity().is_a(boltPrefab_).child_of(part);
+    }
+    part.set<ConveyorPartCD>(partCD);
+    return part;
+  }
+
+  // ベルト上の部品をプールへ戻す
+  void ReleasePart(flecs::entity part) {
+    --activeCount_;
+    PushToPool(part);
+  }
+
+  // 部品とボルトを無効化してプールへ入れる（エンティティは削除しない）
+  void PushToPool(flecs::entity part) {
+    for (const flecs::entity bolt : part.get<ConveyorPartCD>().bolts) {
+      bolt.disable();
+    }
+    part.disable();
+    freeParts_.push_back(part);
+  }
+
+  [[nodiscard]] bool IsCompleted(flecs::entity part) const {
+    const ConveyorPartCD& partCD = part.get<ConveyorPartCD>();
+    for (int32 i = 0; i < partCD.bolt_count; ++i) {
+      if (!partCD.bolts[i].get<ConveyorBoltCD>().is_tightened) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  ConveyorSingletonCD& GetConveyor() {
+    return *world_.get_ref<ConveyorSingletonCD>().get();
+  }
+
+  // データメンバ
+  flecs::world world_;
+  flecs::entity partPrefab_;
+  flecs::entity boltPrefab_;
+  flecs::entity pickingPipeline_;
+  flecs::entity updatePipeline_;
+  flecs::entity drawPipeline_;
+  Array<flecs::entity> freeParts_;  // disable済みで再利用を待つ部品
+  int32 activeCount_ = 0;
+};
@@ -4,6 +4,11 @@
 #pragma once
 #include <Siv3D.hpp>
 
+#include <vector>
+
+#include "FrameWork/Util/AssetCache.h"
+#include "FrameWork/Util/SphereBvh.h"
+#include "Game/utility/GameInput.h"
 #include "HexBolt.h"
 
 // 工場で流れてくる部品の描画と動作を管理するクラス
@@ -13,24 +18,35 @@ class MachineParts {
   // コンストラクタ
   // 速度は外部から毎フレーム渡されるようになったため、コンストラクタで受け取らない
   MachineParts(const Vec3& startPos)
-      : position_(startPos), material_{kMetalColor}, metalTexture_{kMetalTexturePath} {
-    // マテリアルは色で初期化しつつ、金属テクスチャを読み込む
+      : position_(startPos), material_{kMetalColor}, metalTexture_{AssetCache::GetTexture(kMetalTexturePath)} {
+    // マテリアルは色で初期化しつつ、金属テクスチャは共有のものを使う（ディスクからは最初の1回だけ読み込む）
 
     // ボルトを生成
     GenerateBolts();
   }
 
+  // 部品とボルトが使うテクスチャ・メッシュを事前に読み込んでおく
+  // WorkPhaseの生成時に呼べば、部品の生成ではファイル読み込みもGPU転送も発生しない
+  static void PrewarmAssets() {
+    (void)AssetCache::GetTexture(kMetalTexturePath);
+    HexBolt::PrewarmAssets();
+  }
+
   // 毎フレーム呼ばれる更新処理
-  // 位置を移動し、ボルトを更新する。カメラ情報は各ボルトのUpdate()に渡す
+  // 位置を移動し、ボルトを更新する。カメラ情報はボルトのクリック判定に使う
   // 追加の引数 `conveyorSpeed` を受け取り、ベルトのスクロール速度で部品を移動させる
   void Update(double deltaTime, const BasicCamera3D& camera, double conveyorSpeed) {
     // 位置を右に移動（conveyorSpeed によって移動量を決定）
-    const Vec3 delta = Vec3{conveyorSpeed * deltaTime, 0.0, 0.0};
-    position_ += delta;
+    position_.x += conveyorSpeed * deltaTime;
 
-    // 各ボルトを更新（ボルトの位置は部品本体からの相対位置なので、部品の移動量を渡す）
+    // 各ボルトを更新（ボルトは部品本体からの相対位置を持つので、部品の位置だけを渡す）
     for (auto& bolt : bolts_) {
-      bolt.Update(camera, delta);
+      bolt.Update(position_);
+    }
+
+    // クリックされたフレームだけ、カーソルからのレイを1本作ってボルトを選ぶ
+    if (GameInput::LeftDown()) {
+      PickBolt(camera.screenToRay(GameInput::CursorPos()));
     }
   }
 
@@ -84,13 +100,31 @@ class MachineParts {
 
     // ボルトを生成
     for (int32 i = 0; i < boltCount; ++i) {
-      Vec3 boltPos = Vec3{
-        position_.x + Random(-randm_area.x / 2, randm_area.x / 2),
-        position_.y + kBodySize.y / 2 + HexBolt::kBoltHeight / 2,
-        position_.z + Random(-randm_area.y / 2, randm_area.y / 2)};
+      const Vec3 boltOffset = Vec3{
+        Random(-randm_area.x / 2, randm_area.x / 2),
+        kBodySize.y / 2 + HexBolt::kBoltHeight / 2,
+        Random(-randm_area.y / 2, randm_area.y / 2)};
 
       // ボルトを配列に追加
-      bolts_ << HexBolt{boltPos};
+      bolts_ << HexBolt{position_, boltOffset};
+    }
+  }
+
+  // まだ締められていないボルトのクリック判定の球をBVHにまとめ、レイと最初に交差するボルトを締め始める
+  // ECS版コンベア（PickingSystem）と同じSphereBvhで判定する
+  void PickBolt(const Ray& ray) {
+    std::vector<SphereBvh::Item> items;
+    items.reserve(bolts_.size());
+    for (size_t i = 0; i < bolts_.size(); ++i) {
+      if (bolts_[i].IsClickable()) {
+        items.push_back({i, bolts_[i].GetClickSphere()});
+      }
+    }
+
+    SphereBvh bvh;
+    bvh.Build(std::move(items));
+    if (const auto hit = bvh.Raycast(ray)) {
+      bolts_[static_cast<size_t>(hit->id)].Tighten();
     }
   }
 
@@ -99,5 +133,5 @@ class MachineParts {
   // speed_ は削除: 移動速度は update 呼び出し側から渡される
   Array<HexBolt> bolts_;    // 配置されたボルトの配列（2～4個）
   PhongMaterial material_;  // 金属マテリアル
-  Texture metalTexture_;    // 部品本体に貼る金属テクスチャ
+  Texture metalTexture_;    // 部品本体に貼る金属テクスチャ（AssetCacheで共有）
 };
@@ -4,16 +4,20 @@
 #pragma once
 #include <Siv3D.hpp>
 
+#include "FrameWork/Util/AssetCache.h"
+#include "FrameWork/Util/UVScrollMaterial.h"
 #include "Game/base_system/BlackOutUI.h"
 #include "Game/base_system/CommonUI.h"
 #include "Game/base_system/GameCommonData.h"
 #include "Game/base_system/MessageWindowUI.h"
 #include "Game/base_system/PhaseManager.h"
 #include "Game/utility/FontManager.h"
+#include "Game/utility/GameClock.h"
 #include "Game/utility/GameConst.h"
 #include "Game/utility/MouseEffectManager.h"
 #include "Game/utility/SoundManager.h"
 #include "Game/utility/iPhase.h"
+#include "ConveyorWorld.h"
 #include "MachineParts.h"
 
 // アルバイトフェーズを管理するクラス
@@ -28,10 +32,21 @@ class WorkPhase : public iPhase {
     EndFadeWait  // 暗転フェードの終了を待つ
   };
 
+  // 部品の流し方
+  enum class ConveyorMode {
+    Classic,  // 部品を1つずつ流す（MachineParts）
+    Ecs       // 一定間隔で次々に流す高難度モード（ConveyorWorld）
+  };
+
   // 定数
   // ベルトのサイズ 3次元的には(x,z)
   static constexpr Vec2 kBeltSize{GameConst::kWorkAreaWidth, MachineParts::kBodySize.z + 80};
   static constexpr int32 kTargetCompletedCount = 5;  // 目標完了数
+  // 高難度モードはベルトを抜けるまでの約6秒間に数百個の部品が同時に流れる間隔で生成する
+  // 部品は重なり合うため、奥行き方向にもばらして置く
+  static constexpr int32 kEcsTargetCompletedCount = 100;  // 高難度モードの目標完了数
+  static constexpr double kEcsSpawnInterval = 0.025;      // 高難度モードで部品を流す間隔（秒）
+  static constexpr int32 kEcsPoolCapacity = 256;          // 高難度モードで先に作っておく部品の数
   // kPartsSpeed は MachineParts 側で使わなくなったため削除
   static constexpr Vec3 kPartsStartPos{-GameConst::kWorkAreaWidth / 2, 0.0, 0.0};  // 部品の開始位置（画面左外）
   static constexpr Vec3 kCameraPos{0.0, 150.0, -75.0};                             // カメラの位置
@@ -66,22 +81,26 @@ class WorkPhase : public iPhase {
   static constexpr double kRimHeight = 10.0;     // ベルト淵の高さ（Y方向の厚み）
 
   // コンストラクタ
-  WorkPhase() {
+  explicit WorkPhase(ConveyorMode mode = ConveyorMode::Classic)
+      : mode_(mode),
+        targetCount_(mode == ConveyorMode::Ecs ? kEcsTargetCompletedCount
+                                               : kTargetCompletedCount) {
     // カメラと光源を初期化
     SetupCamera();
 
-    beltTexture_ = Texture{kBeltTexturePath};
+    // 部品の生成中にファイル読み込みやGPU転送が起きないよう、共有アセットを先に用意する
+    MachineParts::PrewarmAssets();
 
-    // ベルトを繰り返しテクスチャで表示するためのメッシュデータを作成して保存
-    // MeshData::OneSidedPlane の第2引数で UV スケールや繰り返し回数を指定できる想定
-    // const MeshData md = MeshData::OneSidedPlane(300, {1.0f, 1.0f}, Float2{uvOffset_, 0.0f});
-    const MeshData md = CreateBeltMeshData();
-    beltMesh_ = DynamicMesh(md);
+    beltTexture_ = AssetCache::GetTexture(kBeltTexturePath);
+
+    // ベルトを繰り返しテクスチャで表示するためのメッシュを一度だけ作成する
+    // スクロールはbeltMaterial_のUVオフセットで行うため、メッシュは作り直さない
+    beltMesh_ = Mesh{CreateBeltMeshData()};
 
     // 床用テクスチャとメッシュを作成（テクスチャは繰り返し）
-    checkerTexture_ = Texture{kCheckerBoardTexturePath};
+    checkerTexture_ = AssetCache::GetTexture(kCheckerBoardTexturePath);
     // ベルト淵用の金属ボードテクスチャ
-    metalTexture_ = Texture{kMetalBoardTexturePath};
+    metalTexture_ = AssetCache::GetTexture(kMetalBoardTexturePath);
 
     planeMesh_ = Mesh(MeshData::OneSidedPlane(kFloorSize, {10, 10}));
 
@@ -99,21 +118,34 @@ class WorkPhase : public iPhase {
     MouseEffectManager::SetActiveSound(false);
 
     // 最初の部品を生成
+    // ECS版コンベアのworldは初回だけ作り、以降の日はプールへ戻すだけで使い回す
+    if (mode_ == ConveyorMode::Ecs) {
+      if (!sharedConveyor_) {
+        sharedConveyor_.emplace();
+        sharedConveyor_->Reserve(kEcsPoolCapacity);
+      } else {
+        sharedConveyor_->Reset();
+      }
+      conveyor_ = &*sharedConveyor_;
+    }
     SpawnNewParts();
   }
 
   // デストラクタ
   ~WorkPhase() = default;
 
+  // 日をまたいで使い回しているECS版コンベアを破棄する
+  // 保持しているメッシュとテクスチャをエンジンより先に手放すため、Main()の終了時に呼ぶ
+  static void ReleaseConveyor() {
+    sharedConveyor_.reset();
+  }
+
   // 毎フレーム呼ばれる更新処理
   // 部品の更新、完了判定、フェーズ遷移を管理する
   void update() override {
-    // ベルトのUVスクロールを更新
-    uvOffset_ -= scrollSpeed_ * Scene::DeltaTime();
-
-    // ベルトのメッシュを再作成
-    const MeshData md = CreateBeltMeshData();
-    beltMesh_.fill(md);
+    // ベルトのUVスクロールを更新（定数バッファのオフセットだけを書き換える）
+    uvOffset_ -= scrollSpeed_ * GameClock::DeltaTime();
+    beltMaterial_.SetOffset(Vec2{uvOffset_ / kBeltSize.y, 0.0});
 
     // 状態ごとに更新処理を分岐
     switch (state_) {
@@ -157,7 +189,7 @@ class WorkPhase : public iPhase {
       // ベルトコンベアを描画（Mesh を使ってテクスチャを繰り返し表示）
       {
         const ScopedRenderStates3D sampler{SamplerState::MirrorAniso};
-        beltMesh_.draw(beltTexture_);
+        beltMaterial_.Draw(beltMesh_, beltTexture_);
       }
 
       // ベルトの上下の淵に沿って横長の薄い Box を描画
@@ -176,6 +208,9 @@ class WorkPhase : public iPhase {
       if (currentParts_.has_value()) {
         currentParts_->Draw();
       }
+      if (conveyor_) {
+        conveyor_->Draw();
+      }
     }
 
     // 2D UIを描画
@@ -204,13 +239,16 @@ class WorkPhase : public iPhase {
   void UpdateRunningState() {
     // 部品が存在する場合は更新
     if (currentParts_.has_value()) {
-      currentParts_->Update(Scene::DeltaTime(), camera_, scrollSpeed_);
+      currentParts_->Update(GameClock::DeltaTime(), camera_, scrollSpeed_);
       // 部品の完了判定
       CheckPartsCompletion();
     }
+    if (conveyor_) {
+      UpdateConveyor();
+    }
 
     // 目標数に達したら終了メッセージ表示へ
-    if (completedCount_ >= kTargetCompletedCount) {
+    if (completedCount_ >= targetCount_) {
       // BGMを停止
       SoundManager::StopBGM();
 
@@ -240,18 +278,33 @@ class WorkPhase : public iPhase {
     }
   }
 
-  MeshData CreateBeltMeshData() const {
-    auto normalized = kBeltSize.normalized();
-    auto uv_scale = Float2{kBeltSize.x / kBeltSize.y, 1.0f};
-    const MeshData md = MeshData::Grid(kBeltSize, 1, 1, uv_scale, Float2{uvOffset_ / kBeltSize.y, 0.0f});
-    return md;
+  // ベルトのメッシュデータ（UVはベルトの奥行きを1として横方向に繰り返す）
+  static MeshData CreateBeltMeshData() {
+    const Float2 uv_scale{static_cast<float>(kBeltSize.x / kBeltSize.y), 1.0f};
+    return MeshData::Grid(kBeltSize, 1, 1, uv_scale);
   }
 
   // 新しい部品を生成して画面左から流す
   void SpawnNewParts() {
+    if (conveyor_) {
+      const double laneJitter = (kBeltSize.y - MachineParts::kBodySize.z) / 2;
+      conveyor_->Spawn(kPartsStartPos + Vec3{0.0, 0.0, Random(-laneJitter, laneJitter)});
+      return;
+    }
     currentParts_ = MachineParts{kPartsStartPos};
   }
 
+  // 高難度モード: 一定間隔で部品を流し、画面外に出た部品の完了数を数える
+  void UpdateConveyor() {
+    spawnTimer_ += GameClock::DeltaTime();
+    while (spawnTimer_ >= kEcsSpawnInterval) {
+      spawnTimer_ -= kEcsSpawnInterval;
+      SpawnNewParts();
+    }
+    completedCount_ += conveyor_->Update(GameClock::DeltaTime(), camera_, scrollSpeed_,
+                                         GameConst::kWorkAreaWidth / 2);
+  }
+
   // 部品が画面外に出たか、ボルトを全て締めたかをチェック
   void CheckPartsCompletion() {
     if (!currentParts_.has_value()) {
@@ -271,7 +324,7 @@ class WorkPhase : public iPhase {
       currentParts_.reset();
 
       // 次の部品を生成
-      if (completedCount_ < kTargetCompletedCount) {
+      if (completedCount_ < targetCount_) {
         SpawnNewParts();
       }
     }
@@ -289,7 +342,7 @@ class WorkPhase : public iPhase {
   // 完了数を画面上部に描画
   void DrawCompletionCount() const {
     const Font& font = FontManager::GetFont(U"ui_medium");
-    const String countStr = U"完了: {}/{}"_fmt(completedCount_, kTargetCompletedCount);
+    const String countStr = U"完了: {}/{}"_fmt(completedCount_, targetCount_);
     const Vec2 pos{GameConst::kPlayAreaSize.x / 2, GameConst::kPlayAreaRect.y + 20};
     font(countStr).draw(Arg::center = pos, ColorF{1.0, 1.0, 1.0});
   }
@@ -301,7 +354,11 @@ class WorkPhase : public iPhase {
   }
 
   // データメンバ
+  ConveyorMode mode_ = ConveyorMode::Classic;  // 部品の流し方
   Optional<MachineParts> currentParts_;  // 現在流れている部品（存在しない場合はnone）
+  ConveyorWorld* conveyor_ = nullptr;    // 高難度モードの部品（sharedConveyor_を指す。Classicではnullptr）
+  double spawnTimer_ = 0.0;              // 高難度モードで次の部品を流すまでの経過時間
+  int32 targetCount_ = kTargetCompletedCount;  // 目標完了数
   int32 completedCount_ = 0;             // 完了した部品数
 
   State state_ = State::Running;  // 現在の状態
@@ -309,9 +366,12 @@ class WorkPhase : public iPhase {
   BasicCamera3D camera_;                      // 3D描画用のカメラ
   Mesh planeMesh_;                            // 床用メッシュ
   Texture checkerTexture_;                    // チェッカーボードのテクスチャ
-  DynamicMesh beltMesh_;                      // ベルト用メッシュ（繰り返し表示用）
+  Mesh beltMesh_;                             // ベルト用メッシュ（繰り返し表示用）
+  UVScrollMaterial beltMaterial_;             // ベルトのUVをスクロールさせるマテリアル
   Texture beltTexture_;                       // ベルトコンベアのテクスチャ
   Texture metalTexture_;                      // ベルト淵用の金属テクスチャ
   double scrollSpeed_ = kInitialScrollSpeed;  // ベルトのスクロール速度
   double uvOffset_ = 0.0;                     // ベルトのUVオフセット（スクロール位置）
+
+  static inline Optional<ConveyorWorld> sharedConveyor_;  // 日をまたいで使い回すECS版コンベア
 };
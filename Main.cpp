@@ -2,30 +2,165 @@
 #include <Siv3D.hpp>
 
 #include "Game/base_system/GameManager.h"
+#include "Game/base_system/HeadlessRunner.h"
+#include "Game/base_system/HeadlessScript.h"
 #include "Game/utility/GameConst.h"
 #include "Game/utility/LlmUtil.h"
 #include "Helper/LicenseHelper.h"
-#include "External/60FPSwithAutoFrameSkip.h"
+#include "LlamaCpp/LlamaReplay.h"
+#include "LlamaCpp/LlamaSamplerBenchmark.h"
+#include "Misc/PhysicsBenchmark.h"
+#include "Misc/SpriteAnimationBenchmark.h"
+#include "Misc/UVScrollBenchmark.h"
+#include "Util/AllocationCounter.h"
+#include "Util/FramePacer.h"
+#include "Util/FrameProfiler.h"
 
+#ifdef ENABLE_ALLOCATION_COUNTER
+// ヒープ確保をスレッドごとに数える（HeadlessRunnerのフェーズごとの確保量の計測に使う）
+// 全ての確保に影響するため、計測用のビルドでENABLE_ALLOCATION_COUNTERを定義したときだけ置き換える
+void* operator new(std::size_t size) {
+  return AllocationCounter::Allocate(size);
+}
+
+void operator delete(void* p) noexcept {
+  AllocationCounter::Free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  AllocationCounter::Free(p);
+}
+#endif
+
+namespace {
+
+// LLMの応答の記録ファイル（ヘッドレス実行で指定がない場合に使う）
+constexpr StringView kDefaultLlmReplayPath = U"LlmReplay/playthrough.json";
+
+// --frame-pacer でFPSを省略した場合の目標フレームレート
+constexpr int32 kDefaultPacerFPS = 60;
+
+// コマンドライン引数 name の次の値を取得する（値がない場合は none）
+Optional<String> FindArgValue(const Array<String>& args, StringView name) {
+  for (size_t i = 0; i + 1 < args.size(); ++i) {
+    if (args[i] == name && !args[i + 1].starts_with(U"--")) {
+      return args[i + 1];
+    }
+  }
+  return none;
+}
+
+// --bench で指定された名前のベンチマークを実行する（結果はコンソールに出力される）
+void RunBenchmark(StringView name) {
+  if (name == U"sampler") {
+    llama_cpp::LlamaSamplerBenchmark::RunAll();
+    return;
+  }
+  if (name == U"physics") {
+    PhysicsBenchmark::RunInNewWorld();
+    return;
+  }
+  if (name == U"sprite") {
+    SpriteAnimationBenchmark::Run();
+    return;
+  }
+  if (name == U"uvscroll") {
+    UVScrollBenchmark::Run();
+    return;
+  }
+  Console << U"--bench: 不明なベンチマーク名です: " << name;
+}
+
+}  // namespace
+
+// コマンドライン引数
+//   --headless [記録ファイル] : 描画せずにスクリプトの入力で3日間を通しでプレイし、フェーズごとの計測結果を出力して終了する
+//                               LLMは記録ファイルの応答を再生する（省略時は kDefaultLlmReplayPath）
+//   --report <パス>           : --headless の計測結果をファイルにも書き出す
+//   --record-llm <パス>       : 通常のプレイ中のLLMの応答を記録し、終了時に保存する（--headless で再生できる）
+//   --frame-pacer [FPS]       : VSyncを切り、FramePacerで指定のフレームレートに揃える（省略時は kDefaultPacerFPS）
+//   --ecs-conveyor            : 作業フェーズを部品が次々に流れるECS版コンベアで遊ぶ（計測・デバッグ用。--headless と併用できる）
+//   --bench <名前>            : ベンチマークを実行し、結果をコンソールに出力して終了する
+//                               sampler: LLMのサンプラーチェーン
+//                               physics: PhysXの同期実行と非同期実行
+//                               sprite : アニメーションスプライトの更新のスレッド数によるスケーリング
+//                               uvscroll: ベルトのUVスクロールのメッシュ再構築と定数バッファ更新
 void Main() {
   LicenseHelper::AddLicenses();
 
-  Graphics::SetVSyncEnabled(true);
+  // プロファイラー（デバッグ表示の有効化中のみ計測する）
+  FrameProfiler::SetThreadName("main");
+  FrameProfiler::InstallFlecsHooks();
 
   Window::Resize(GameConst::kWindowSize);
   Window::SetTitle(GameConst::kWindowTitle);
 
+  const Array<String> args = System::GetCommandLineArgs();
+
+  // フレームの待ちは既定ではVSyncに任せる（ティアリングを防ぎ、高リフレッシュレートの画面でも上限をかけない）
+  // --frame-pacer 指定時だけVSyncを切り、FramePacerで一定のフレームレートに揃える（VSyncと併用すると待ちが二重になる）
+  if (args.includes(U"--frame-pacer")) {
+    const Optional<String> fpsArg = FindArgValue(args, U"--frame-pacer");
+    const int32 fps = fpsArg ? ParseOr<int32>(*fpsArg, kDefaultPacerFPS) : kDefaultPacerFPS;
+    Graphics::SetVSyncEnabled(false);
+    FramePacer::SetTargetFPS(fps);
+  }
+
+  if (args.includes(U"--ecs-conveyor")) {
+    GameManager::SetWorkConveyorMode(WorkPhase::ConveyorMode::Ecs);
+  }
+
+  // ベンチマーク（ゲームもLLMモデルも初期化しない）
+  if (const Optional<String> benchName = FindArgValue(args, U"--bench")) {
+    RunBenchmark(*benchName);
+    return;
+  }
+
+  // ヘッドレス実行（LLMモデルは読み込まない）
+  if (args.includes(U"--headless")) {
+    HeadlessRunner::Config config;
+    config.llm_replay_path = FindArgValue(args, U"--headless").value_or(String{kDefaultLlmReplayPath});
+    config.report_path = FindArgValue(args, U"--report").value_or(U"");
+    HeadlessRunner::Run(config, HeadlessScript::DefaultPlaythrough());
+    llama_cpp::LlamaPrefetchScheduler::GetInstance().Shutdown();
+    WorkPhase::ReleaseConveyor();
+    return;
+  }
+
+  const Optional<String> recordLlmPath = FindArgValue(args, U"--record-llm");
+  if (recordLlmPath) {
+    llama_cpp::LlamaReplay::StartRecording();
+  }
+
   // LLMモデルの初期化
   LlmUtil::InitializeLLM();
 
   // GameManagerの初期化
   GameManager::Initialize();
 
-  while (System::Update()) {
+  while (FramePacer::Update()) {
+    FrameProfiler::BeginFrame();
+
     // 背景をクリア
     Scene::SetBackground(ColorF(0.8, 0.9, 1.0));
 
     GameManager::Update();
     GameManager::Draw();
   }
+
+  // LLM先読みのワーカースレッドを停止（静的オブジェクトの破棄より前に行う）
+  llama_cpp::LlamaPrefetchScheduler::GetInstance().Shutdown();
+
+  // 先読みで用意したまま残っているジェネレーターを先に破棄し、コンテキストをプールへ返す
+  JobSearchPhase::ReleasePreparedGenerator();
+
+  // プールに残っているコンテキストとモデルを解放する（プールは破棄されないため、ここで明示的に手放す）
+  llama_cpp::LlamaModelManager::GetInstance().ReleaseAllModels();
+
+  // 作業フェーズで使い回しているECS版コンベアを破棄する
+  WorkPhase::ReleaseConveyor();
+
+  if (recordLlmPath) {
+    llama_cpp::LlamaReplay::Save(*recordLlmPath);
+  }
 }